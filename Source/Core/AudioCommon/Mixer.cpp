@@ -3,11 +3,14 @@
 // Refer to the license.txt file included.
 // Modified For Ishiiruka By Tino
 
+#include <algorithm>
+
 #include "AudioCommon/Mixer.h"
 #include "AudioCommon/AudioCommon.h"
 #include "Common/Atomic.h"
 #include "Common/CPUDetect.h"
 #include "Common/CommonFuncs.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -34,44 +37,127 @@ CMixer::CMixer(u32 BackendSampleRate)
 	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 }
 
-void CMixer::LinearMixerFifo::Interpolate(u32 left_input_index, float *left_output, float *right_output)
+static const float cubic_coef[] = {-0.5f, 1.0f, -0.5f, 0.0f, 1.5f, -2.5f, 0.0f, 1.0f,
+                                   -1.5f, 2.0f, 0.5f,  0.0f, 0.5f, -0.5f, 0.0f, 0.0f};
+
+#ifdef _M_X86
+// Loads the stereo frames at index0 + offset and index1 + offset into one register.
+static inline __m128 LoadFramePair(const float* buffer, u32 index0, u32 index1, u32 offset)
+{
+	__m128 frames = _mm_castpd_ps(_mm_load_sd(
+		reinterpret_cast<const double*>(&buffer[(index0 + offset) & CMixer::INDEX_MASK])));
+	return _mm_loadh_pi(frames,
+		reinterpret_cast<const __m64*>(&buffer[(index1 + offset) & CMixer::INDEX_MASK]));
+}
+
+// The buffer holds left then right, the output wants right then left.
+static inline void AddFramePair(float* output, __m128 frames, __m128 volume)
 {
-	*left_output = (1 - m_fraction) * m_float_buffer[left_input_index & INDEX_MASK] +
-	               m_fraction * m_float_buffer[(left_input_index + 2) & INDEX_MASK];
-	*right_output = (1 - m_fraction) * m_float_buffer[(left_input_index + 1) & INDEX_MASK] +
-	                m_fraction * m_float_buffer[(left_input_index + 3) & INDEX_MASK];
+	frames = _mm_shuffle_ps(frames, frames, _MM_SHUFFLE(2, 3, 0, 1));
+	_mm_storeu_ps(output, _mm_add_ps(_mm_loadu_ps(output), _mm_mul_ps(volume, frames)));
 }
+#endif
 
-void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float *left_output, float *right_output)
+void CMixer::LinearMixerFifo::Interpolate(const u32* indices, const float* fractions, u32 count,
+	const float* volume, float* output)
 {
-	static const float cubic_coef[] = {-0.5f, 1.0f, -0.5f, 0.0f, 1.5f, -2.5f, 0.0f, 1.0f,
-	                                   -1.5f, 2.0f, 0.5f,  0.0f, 0.5f, -0.5f, 0.0f, 0.0f};
-
-	const float x2 = m_fraction; // x
-	const float x1 = x2 * x2;    // x^2
-	const float x0 = x1 * x2;    // x^3
-
-	float y0 = cubic_coef[0] * x0 + cubic_coef[1] * x1 + cubic_coef[2] * x2 + cubic_coef[3];
-	float y1 = cubic_coef[4] * x0 + cubic_coef[5] * x1 + cubic_coef[6] * x2 + cubic_coef[7];
-	float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
-	float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
-
-	*left_output = y0 * m_float_buffer[left_input_index & INDEX_MASK] +
-	               y1 * m_float_buffer[(left_input_index + 2) & INDEX_MASK] +
-	               y2 * m_float_buffer[(left_input_index + 4) & INDEX_MASK] +
-	               y3 * m_float_buffer[(left_input_index + 6) & INDEX_MASK];
-	*right_output = y0 * m_float_buffer[(left_input_index + 1) & INDEX_MASK] +
-	                y1 * m_float_buffer[(left_input_index + 3) & INDEX_MASK] +
-	                y2 * m_float_buffer[(left_input_index + 5) & INDEX_MASK] +
-	                y3 * m_float_buffer[(left_input_index + 7) & INDEX_MASK];
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 vol = _mm_setr_ps(volume[0], volume[1], volume[0], volume[1]);
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i + 2 <= count; i += 2)
+	{
+		const __m128 a = LoadFramePair(m_float_buffer.data(), indices[i], indices[i + 1], 0);
+		const __m128 b = LoadFramePair(m_float_buffer.data(), indices[i], indices[i + 1], 2);
+		const __m128 fraction =
+			_mm_setr_ps(fractions[i], fractions[i], fractions[i + 1], fractions[i + 1]);
+		const __m128 frames =
+			_mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, fraction), a), _mm_mul_ps(fraction, b));
+		AddFramePair(&output[i * 2], frames, vol);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const u32 index = indices[i];
+		const float fraction = fractions[i];
+		const float l_output = (1 - fraction) * m_float_buffer[index & INDEX_MASK] +
+		                       fraction * m_float_buffer[(index + 2) & INDEX_MASK];
+		const float r_output = (1 - fraction) * m_float_buffer[(index + 1) & INDEX_MASK] +
+		                       fraction * m_float_buffer[(index + 3) & INDEX_MASK];
+		output[i * 2] += volume[0] * r_output;
+		output[i * 2 + 1] += volume[1] * l_output;
+	}
+}
+
+void CMixer::CubicMixerFifo::Interpolate(const u32* indices, const float* fractions, u32 count,
+	const float* volume, float* output)
+{
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 vol = _mm_setr_ps(volume[0], volume[1], volume[0], volume[1]);
+	const float* buffer = m_float_buffer.data();
+	for (; i + 4 <= count; i += 4)
+	{
+		// Weights of four output frames at once, in the same order of operations as below.
+		const __m128 x2 = _mm_loadu_ps(&fractions[i]);
+		const __m128 x1 = _mm_mul_ps(x2, x2);
+		const __m128 x0 = _mm_mul_ps(x1, x2);
+		__m128 y[4];
+		for (int j = 0; j < 4; j++)
+		{
+			y[j] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(cubic_coef[j * 4]), x0),
+				_mm_mul_ps(_mm_set1_ps(cubic_coef[j * 4 + 1]), x1));
+			y[j] = _mm_add_ps(y[j], _mm_mul_ps(_mm_set1_ps(cubic_coef[j * 4 + 2]), x2));
+			y[j] = _mm_add_ps(y[j], _mm_set1_ps(cubic_coef[j * 4 + 3]));
+		}
+
+		for (u32 pair = 0; pair < 2; pair++)
+		{
+			const u32 index0 = indices[i + pair * 2];
+			const u32 index1 = indices[i + pair * 2 + 1];
+			__m128 frames = _mm_setzero_ps();
+			for (u32 tap = 0; tap < 4; tap++)
+			{
+				const __m128 weight =
+					pair == 0 ? _mm_unpacklo_ps(y[tap], y[tap]) : _mm_unpackhi_ps(y[tap], y[tap]);
+				const __m128 taps = _mm_mul_ps(weight, LoadFramePair(buffer, index0, index1, tap * 2));
+				frames = tap == 0 ? taps : _mm_add_ps(frames, taps);
+			}
+			AddFramePair(&output[(i + pair * 2) * 2], frames, vol);
+		}
+	}
+#endif
+	for (; i < count; i++)
+	{
+		const u32 index = indices[i];
+		const float x2 = fractions[i];  // x
+		const float x1 = x2 * x2;       // x^2
+		const float x0 = x1 * x2;       // x^3
+
+		float y0 = cubic_coef[0] * x0 + cubic_coef[1] * x1 + cubic_coef[2] * x2 + cubic_coef[3];
+		float y1 = cubic_coef[4] * x0 + cubic_coef[5] * x1 + cubic_coef[6] * x2 + cubic_coef[7];
+		float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
+		float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
+
+		const float l_output = y0 * m_float_buffer[index & INDEX_MASK] +
+		                       y1 * m_float_buffer[(index + 2) & INDEX_MASK] +
+		                       y2 * m_float_buffer[(index + 4) & INDEX_MASK] +
+		                       y3 * m_float_buffer[(index + 6) & INDEX_MASK];
+		const float r_output = y0 * m_float_buffer[(index + 1) & INDEX_MASK] +
+		                       y1 * m_float_buffer[(index + 3) & INDEX_MASK] +
+		                       y2 * m_float_buffer[(index + 5) & INDEX_MASK] +
+		                       y3 * m_float_buffer[(index + 7) & INDEX_MASK];
+		output[i * 2] += volume[0] * r_output;
+		output[i * 2 + 1] += volume[1] * l_output;
+	}
 }
 
 void CMixer::MixerFifo::Mix(float *samples, u32 numSamples, bool consider_framelimit)
 {
 	u32 current_sample = 0;
 	// Cache access in non-volatile variable so interpolation loop can be optimized
-	u32 read_index = m_read_index.load();
-	const u32 write_index = m_write_index.load();
+	u32 read_index = m_read_index.load(std::memory_order_relaxed);
+	const u32 write_index = m_write_index.load(std::memory_order_acquire);
 	// Sync input rate by fifo size
 	float num_left = (float)(((write_index - read_index) & INDEX_MASK) / 2);
 	m_num_left_i = (num_left + m_num_left_i * (CONTROL_AVG - 1)) / CONTROL_AVG;
@@ -94,22 +180,36 @@ void CMixer::MixerFifo::Mix(float *samples, u32 numSamples, bool consider_framel
 	float ratio = aid_sample_rate / (float)m_mixer->m_sample_rate;
 	float l_volume = (float)m_lvolume.load() / 256.f;
 	float r_volume = (float)m_rvolume.load() / 256.f;
+	const float volume[2] = { r_volume, l_volume };
+	const u32 window_size = GetWindowSize();
 	// for each output sample pair (left and right),
-	// linear interpolate between current and next sample
+	// interpolate between the surrounding input samples
 	// increment output sample position
 	// increment input sample position by ratio, store fraction
+	// The input positions depend on each other and are stepped through one by one,
+	// the interpolation itself is done for a whole batch of frames at once.
 	// QUESTION: do we need to check for NUM_CROSSINGS samples before we interpolate?
 	// seems to work fine as is
-	for (; current_sample < numSamples * 2 && ((write_index - read_index) & INDEX_MASK) > GetWindowSize();
-	     current_sample += 2)
+	u32 indices[BATCH_SIZE];
+	float fractions[BATCH_SIZE];
+	while (current_sample < numSamples * 2)
 	{
-		float l_output, r_output;
-		Interpolate(read_index, &l_output, &r_output);
-		samples[current_sample + 1] += l_volume * l_output;
-		samples[current_sample] += r_volume * r_output;
-		m_fraction += ratio;
-		read_index += 2 * (s32)m_fraction;
-		m_fraction = m_fraction - (s32)m_fraction;
+		u32 count = 0;
+		for (; count < BATCH_SIZE && current_sample + count * 2 < numSamples * 2 &&
+		       ((write_index - read_index) & INDEX_MASK) > window_size;
+		     count++)
+		{
+			indices[count] = read_index & INDEX_MASK;
+			fractions[count] = m_fraction;
+			m_fraction += ratio;
+			read_index += 2 * (s32)m_fraction;
+			m_fraction = m_fraction - (s32)m_fraction;
+		}
+		if (count == 0)
+			break;
+
+		Interpolate(indices, fractions, count, volume, &samples[current_sample]);
+		current_sample += count * 2;
 	}
 	// pad output if not enough input samples
 	float s[2];
@@ -121,7 +221,7 @@ void CMixer::MixerFifo::Mix(float *samples, u32 numSamples, bool consider_framel
 		samples[current_sample + 1] += s[1];
 	}
 	// update read index
-	m_read_index.store(read_index);
+	m_read_index.store(read_index, std::memory_order_release);
 }
 
 u32 CMixer::MixerFifo::AvailableSamples()
@@ -155,7 +255,22 @@ u32 CMixer::Mix(s16 *samples, u32 num_samples, bool consider_framelimit)
 	m_streaming_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	m_wiimote_speaker_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	// dither and clamp
-	for (u32 i = 0; i < num_samples * 2; i += 2)
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 min_output = _mm_set1_ps(-32768.f);
+	const __m128 max_output = _mm_set1_ps(32767.f);
+	for (; i + 8 <= num_samples * 2; i += 8)
+	{
+		__m128 a = _mm_mul_ps(_mm_loadu_ps(&m_output_buffer[i]), scale);
+		__m128 b = _mm_mul_ps(_mm_loadu_ps(&m_output_buffer[i + 4]), scale);
+		a = _mm_min_ps(_mm_max_ps(a, min_output), max_output);
+		b = _mm_min_ps(_mm_max_ps(b, min_output), max_output);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&samples[i]),
+			_mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+	}
+#endif
+	for (; i < num_samples * 2; i += 2)
 	{
 		float r_output = m_output_buffer[i] * 32768.0f;
 		float l_output = m_output_buffer[i + 1] * 32768.0f;
@@ -179,15 +294,35 @@ u32 CMixer::Mix(float *samples, u32 num_samples, bool consider_framelimit)
 	return num_samples;
 }
 
+// Converts big endian samples to float.
+static void ConvertSamples(const s16* samples, float* output, u32 count)
+{
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+		values = _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+		const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+		const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+		_mm_storeu_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+		_mm_storeu_ps(&output[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+	}
+#endif
+	for (; i < count; i++)
+		output[i] = Signed16ToFloat(Common::swap16(samples[i]));
+}
+
 void CMixer::MixerFifo::PushSamples(const s16 *samples, u32 num_samples)
 {
 	// Cache access in non-volatile variable
 	// indexR isn't allowed to cache in the audio throttling loop as it
 	// needs to get updates to not deadlock.
-	u32 current_write_index = m_write_index.load();
+	u32 current_write_index = m_write_index.load(std::memory_order_relaxed);
 	// Check if we have enough free space
 	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((current_write_index - m_read_index.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
+	if (num_samples * 2 + ((current_write_index - m_read_index.load(std::memory_order_acquire)) & INDEX_MASK) >= MAX_SAMPLES * 2)
 	{
 		// @TODO: We would ideally like to be able to push Jukebox audio samples through Dolphin's mixer,
 		// however attempts at doing so seem to conflict with some expected logic regarding sample submission.
@@ -200,13 +335,15 @@ void CMixer::MixerFifo::PushSamples(const s16 *samples, u32 num_samples)
 
 	// AyuanX: Actual re-sampling work has been moved to sound thread
 	// to alleviate the workload on main thread
-	// convert to float while copying to buffer
-	for (u32 i = 0; i < num_samples * 2; ++i)
-	{
-		m_float_buffer[(current_write_index + i) & INDEX_MASK] = Signed16ToFloat(Common::swap16(samples[i]));
-	}
-	m_write_index.fetch_add(num_samples * 2);
-	return;
+	// convert to float while copying to buffer, in two runs if the buffer wraps around
+	const u32 count = num_samples * 2;
+	const u32 start = current_write_index & INDEX_MASK;
+	const u32 first_run = std::min(count, MAX_SAMPLES * 2 - start);
+	ConvertSamples(samples, &m_float_buffer[start], first_run);
+	ConvertSamples(samples + first_run, &m_float_buffer[0], count - first_run);
+
+	// Only this thread writes the write index, publish the samples with it.
+	m_write_index.store(current_write_index + count, std::memory_order_release);
 }
 
 void CMixer::PushSamples(const s16 *samples, u32 num_samples)
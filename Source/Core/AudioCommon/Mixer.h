@@ -72,16 +72,21 @@ public:
 	}
 
 protected:
+	// Single producer (emulation thread), single consumer (audio thread) ring buffer of
+	// interleaved stereo samples, resampled to the backend rate on the way out.
 	class MixerFifo
 	{
 	public:
+		// Output frames whose input positions are worked out before they get interpolated together.
+		static const u32 BATCH_SIZE = 8;
+
 		MixerFifo(CMixer *mixer, unsigned sample_rate)
 			: m_mixer(mixer)
 			, m_input_sample_rate(sample_rate)
-			, m_write_index(0)
-			, m_read_index(0)
 			, m_lvolume(255)
 			, m_rvolume(255)
+			, m_write_index(0)
+			, m_read_index(0)
 			, m_num_left_i(0.0f)
 			, m_fraction(0)
 		{
@@ -89,7 +94,10 @@ protected:
 			m_float_buffer.fill(0.0f);
 		}
 		virtual u32 GetWindowSize() = 0;
-		virtual void Interpolate(u32 left_input_index, float* left_output, float* right_output) = 0;
+		// Adds count interpolated frames, scaled by volume, to the interleaved output.
+		// indices are positions in m_float_buffer, already masked.
+		virtual void Interpolate(const u32* indices, const float* fractions, u32 count,
+			const float* volume, float* output) = 0;
 		void PushSamples(const s16* samples, u32 num_samples);
 		void Mix(float* samples, u32 numSamples, bool consider_framelimit = true);
 		void SetInputSampleRate(u32 rate);
@@ -101,15 +109,16 @@ protected:
 		CMixer *m_mixer;
 		unsigned m_input_sample_rate;
 
-		std::array<float, MAX_SAMPLES * 2> m_float_buffer;
-
-		std::atomic<u32> m_write_index;
-		std::atomic<u32> m_read_index;
-
 		// Volume ranges from 0-255
 		std::atomic<s32> m_lvolume;
 		std::atomic<s32> m_rvolume;
 
+		// The write index and the read index are kept on opposite sides of the buffer,
+		// so the producer and the consumer never write to the same cache line.
+		std::atomic<u32> m_write_index;
+		std::array<float, MAX_SAMPLES * 2> m_float_buffer;
+		std::atomic<u32> m_read_index;
+
 		float m_num_left_i;
 		float m_fraction;
 	};
@@ -119,7 +128,8 @@ protected:
 	public:
 		LinearMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
 		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
+		void Interpolate(const u32* indices, const float* fractions, u32 count, const float* volume,
+			float* output) override;
 		u32 GetWindowSize() override
 		{
 			return 4;
@@ -131,7 +141,8 @@ protected:
 	public:
 		CubicMixerFifo(CMixer* mixer, u32 sample_rate): MixerFifo(mixer, sample_rate)
 		{}
-		void Interpolate(u32 left_input_index, float* left_output, float* right_output) override;
+		void Interpolate(const u32* indices, const float* fractions, u32 count, const float* volume,
+			float* output) override;
 		u32 GetWindowSize() override
 		{
 			return 8;
@@ -13,6 +13,7 @@
 // - Zero backwards/forwards compatibility
 // - Serialization code for anything complex has to be manually written.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <deque>
@@ -68,6 +69,13 @@ public:
 
 public:
 	PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
+	// Writes into buffer, resizing it when it runs out of room, so the state is saved in a
+	// single pass without measuring it first. *ptr_ must point into buffer. The caller
+	// trims the buffer to *ptr_ afterwards.
+	PointerWrap(u8** ptr_, std::vector<u8>* buffer)
+		: ptr(ptr_), mode(MODE_WRITE), m_buffer(buffer)
+	{
+	}
 	void SetMode(Mode mode_) { mode = mode_; }
 	Mode GetMode() const { return mode; }
 	template <typename K, class V>
@@ -264,6 +272,8 @@ public:
 	}
 
 private:
+	std::vector<u8>* m_buffer = nullptr;
+
 	template <typename T>
 	void DoContainer(T& x)
 	{
@@ -279,6 +289,8 @@ private:
 			break;
 
 		case MODE_WRITE:
+			if (m_buffer && *ptr + size > m_buffer->data() + m_buffer->size())
+				GrowBuffer(size);
 			memcpy(*ptr, data, size);
 			break;
 
@@ -294,6 +306,15 @@ private:
 
 		*ptr += size;
 	}
+
+	void GrowBuffer(u32 size)
+	{
+		static const size_t MIN_BUFFER_SIZE = 1024 * 1024;
+
+		const size_t offset = *ptr - m_buffer->data();
+		m_buffer->resize(std::max({offset + size, m_buffer->size() * 2, MIN_BUFFER_SIZE}));
+		*ptr = m_buffer->data() + offset;
+	}
 };
 
 // NOTE: this class is only used in DolphinWX/ISOFile.cpp for caching loaded
@@ -64,6 +64,7 @@
 #define CACHE_DIR "Cache"
 #define SHADERCACHE_DIR "Shaders"
 #define SHADERUIDCACHE_DIR "ShadersUIDS"
+#define JITCACHE_DIR "JIT"
 #define STATESAVES_DIR "StateSaves"
 #define SCREENSHOTS_DIR "ScreenShots"
 #define OPENCL_DIR "OpenCL"
@@ -115,6 +116,7 @@
 // Files in the directory returned by GetUserPath(D_MEMORYWATCHER_IDX)
 #define MEMORYWATCHER_LOCATIONS "Locations.txt"
 #define MEMORYWATCHER_SOCKET "MemoryWatcher"
+#define MEMORYWATCHER_SNAPSHOT "Snapshot.txt"
 
 // Sys files
 #define TOTALDB "totaldb.dsy"
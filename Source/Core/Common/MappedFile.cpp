@@ -0,0 +1,147 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
+#include "Common/Logging/Log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace File
+{
+MappedFile::MappedFile() : m_data(nullptr), m_size(0)
+#ifdef _WIN32
+	, m_mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The mapping keeps its own reference to the file.
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_data = static_cast<u8*>(view);
+	m_size = static_cast<u64>(size.QuadPart);
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping keeps its own reference to the file.
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		WARN_LOG(COMMON, "Failed to map %s, falling back to buffered reads", filename.c_str());
+		return false;
+	}
+
+	m_data = static_cast<u8*>(view);
+	m_size = static_cast<u64>(st.st_size);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (!m_data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	munmap(m_data, static_cast<size_t>(m_size));
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+const u8* MappedFile::GetPointer(u64 offset, u64 length) const
+{
+	if (!m_data || offset > m_size || length > m_size - offset)
+		return nullptr;
+
+	return m_data + offset;
+}
+
+bool MappedFile::Read(u64 offset, u64 length, u8* out) const
+{
+	const u8* src = GetPointer(offset, length);
+	if (!src)
+		return false;
+
+	std::memcpy(out, src, static_cast<size_t>(length));
+	return true;
+}
+
+void MappedFile::Prefetch(u64 offset, u64 length) const
+{
+#ifndef _WIN32
+	if (!GetPointer(offset, length))
+		return;
+
+	// madvise wants a page aligned start address.
+	const uintptr_t page_mask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+	const uintptr_t start = reinterpret_cast<uintptr_t>(m_data + offset);
+	const uintptr_t aligned = start & ~page_mask;
+	madvise(reinterpret_cast<void*>(aligned), static_cast<size_t>(length + (start - aligned)),
+		MADV_WILLNEED);
+#endif
+}
+
+}  // namespace File
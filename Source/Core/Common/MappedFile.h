@@ -0,0 +1,51 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/NonCopyable.h"
+
+namespace File
+{
+// Read-only view of a whole file backed by the OS page cache.
+// Several processes mapping the same file share the same physical pages, and
+// reads are plain memory accesses instead of seek + read syscalls.
+// Open() fails (and callers are expected to fall back to IOFile) when the file
+// is empty or the platform refuses the mapping, e.g. on some network shares.
+class MappedFile : public NonCopyable
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+	// Copies [offset, offset + length) into out. Returns false if the range is out of bounds.
+	bool Read(u64 offset, u64 length, u8* out) const;
+
+	// Returns a pointer into the mapping, or nullptr if the range is out of bounds.
+	const u8* GetPointer(u64 offset, u64 length) const;
+
+	// Hint the kernel that the range will be read sequentially soon.
+	void Prefetch(u64 offset, u64 length) const;
+
+private:
+	u8* m_data;
+	u64 m_size;
+
+#ifdef _WIN32
+	void* m_mapping;
+#endif
+};
+
+}  // namespace File
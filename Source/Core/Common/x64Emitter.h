@@ -284,9 +284,10 @@ private:
 	void WriteSSEOp(u8 opPrefix, u16 op, X64Reg regOp, OpArg arg, int extrabytes = 0);
 	void WriteSSSE3Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
 	void WriteSSE41Op(u8 opPrefix, u16 op, X64Reg regOp, const OpArg& arg, int extrabytes = 0);
-	void WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0, int extrabytes = 0);
+	void WriteVEXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0, int extrabytes = 0, int L = 0);
 	void WriteVEXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, X64Reg regOp3, int W = 0);
-	void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0, int extrabytes = 0);
+	void WriteAVXOp(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0, int extrabytes = 0, int L = 0);
+	void WriteAVX2Op(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int extrabytes = 0);
 	void WriteAVXOp4(u8 opPrefix, u16 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, X64Reg regOp3, int W = 0);
 	void WriteFMA3Op(u8 op, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0);
 	void WriteFMA4Op(u8 op, X64Reg dest, X64Reg regOp1, X64Reg regOp2, const OpArg& arg, int W = 0);
@@ -792,6 +793,27 @@ public:
 	void VPOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
 	void VPXOR(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
 
+	// AVX: 128-bit moves, VEX encoded so they can be mixed with 256-bit code without transition stalls.
+	void VMOVD_xmm(X64Reg dest, const OpArg& arg);
+	void VMOVQ_xmm(X64Reg dest, const OpArg& arg);
+	void VMOVDQU(X64Reg dest, const OpArg& arg);
+	void VMOVSS(const OpArg& arg, X64Reg src);
+	void VMOVLPS(const OpArg& arg, X64Reg src);
+	void VMOVUPS(const OpArg& arg, X64Reg src);
+	void VZEROUPPER();
+
+	// AVX/AVX2: 256-bit forms, all operands are YMM registers. VBROADCASTSS and VBROADCASTI128 only take a memory source.
+	void VBROADCASTSS(X64Reg dest, const OpArg& arg);
+	void VCVTDQ2PS(X64Reg dest, const OpArg& arg);
+	void VMULPS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+	void VPSHUFB(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
+	void VPSRAD(X64Reg dest, X64Reg src, u8 shift);
+	void VPBROADCASTD(X64Reg dest, const OpArg& arg);
+	void VPBROADCASTQ(X64Reg dest, const OpArg& arg);
+	void VBROADCASTI128(X64Reg dest, const OpArg& arg);
+	void VPBLENDD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 blend);
+	void VEXTRACTI128(const OpArg& arg, X64Reg src, u8 lane);
+
 	// FMA3
 	void VFMADD132PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
 	void VFMADD213PS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg);
@@ -683,6 +683,19 @@ void SConfig::LoadCoreSettings(IniFile &ini)
 	core->Get("SyncGpuMinDistance", &iSyncGpuMinDistance, -200000);
 	core->Get("SyncGpuOverclock", &fSyncGpuOverclock, 1.0);
 	core->Get("FastDiscSpeed", &bFastDiscSpeed, false);
+	core->Get("GCZCacheSize", &iGCZCacheSize, 32);
+	core->Get("GCZCodec", &iGCZCodec, 0);
+	core->Get("MemoryWatcherBinary", &bMemoryWatcherBinary, false);
+	core->Get("MemoryWatcherSharedMemory", &m_strMemoryWatcherSharedMemory, "");
+	core->Get("MemorySnapshotSharedMemory", &m_strMemorySnapshotSharedMemory, "");
+	core->Get("MemorySnapshotSlots", &iMemorySnapshotSlots, 256);
+	core->Get("MemorySnapshotBackPressure", &bMemorySnapshotBackPressure, false);
+	core->Get("StateCodec", &iStateCodec, 0);
+	core->Get("StateCompressionLevel", &iStateCompressionLevel, 6);
+	core->Get("Rewind", &bRewind, false);
+	core->Get("RewindInterval", &iRewindInterval, 10);
+	core->Get("RewindMemoryMB", &iRewindMemoryMB, 256);
+	core->Get("PersistentJITCache", &bPersistentJITCache, false);
 	core->Get("DCBZ", &bDCBZOFF, false);
 	core->Get("FPRF", &bFPRF, false);
 	core->Get("AccurateNaNs", &bAccurateNaNs, false);
@@ -851,6 +864,19 @@ void SConfig::LoadDefaults()
 	iPollingMethod = POLLING_ONSIREAD;
 	bSyncGPU = false;
 	bFastDiscSpeed = false;
+	iGCZCacheSize = 32;
+	iGCZCodec = 0;
+	bMemoryWatcherBinary = false;
+	m_strMemoryWatcherSharedMemory.clear();
+	m_strMemorySnapshotSharedMemory.clear();
+	iMemorySnapshotSlots = 256;
+	bMemorySnapshotBackPressure = false;
+	iStateCodec = 0;
+	iStateCompressionLevel = 6;
+	bRewind = false;
+	iRewindInterval = 10;
+	iRewindMemoryMB = 256;
+	bPersistentJITCache = false;
 	m_strWiiSDCardPath = "";
 	bEnableMemcardSdWriting = true;
 	SelectedLanguage = 0;
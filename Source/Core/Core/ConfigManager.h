@@ -189,6 +189,19 @@ struct SConfig : NonCopyable
 	bool bDCBZOFF = false;
 	int iBBDumpPort = 0;
 	bool bFastDiscSpeed = false;
+	int iGCZCacheSize = 32;  // MiB of decompressed GCZ blocks kept around
+	int iGCZCodec = 0;       // DiscIO::GCZCodec used to compress new images
+	bool bMemoryWatcherBinary = false;
+	std::string m_strMemoryWatcherSharedMemory;  // POSIX shared memory name, empty to use the socket
+	std::string m_strMemorySnapshotSharedMemory;  // Empty to disable per frame snapshots
+	int iMemorySnapshotSlots = 256;
+	bool bMemorySnapshotBackPressure = false;
+	int iStateCodec = 0;  // State::StateCodec
+	int iStateCompressionLevel = 6;  // Only used by zlib
+	bool bRewind = false;
+	int iRewindInterval = 10;  // Frames between captures
+	int iRewindMemoryMB = 256;
+	bool bPersistentJITCache = false;
 	int iVideoRate = 8;
 	bool bHalfAudioRate = false;
 
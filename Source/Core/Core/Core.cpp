@@ -36,6 +36,7 @@
 #include "Core/Host.h"
 #include "Core/MemTools.h"
 #ifdef USE_MEMORYWATCHER
+#include "Core/MemorySnapshot.h"
 #include "Core/MemoryWatcher.h"
 #endif
 #include "Core/Boot/Boot.h"
@@ -58,6 +59,7 @@
 #include "Core/IPC_HLE/WII_IPC_HLE_WiiMote.h"
 #include "Core/IPC_HLE/WII_Socket.h"
 #include "Core/Movie.h"
+#include "Core/Rewind.h"
 #include "Core/NetPlayClient.h"
 #include "Core/NetPlayProto.h"
 #include "Core/PatchEngine.h"
@@ -320,6 +322,7 @@ void Stop() // - Hammertime!
 #ifdef USE_MEMORYWATCHER
 	MemoryWatcher::Shutdown();
 #endif
+	Rewind::Shutdown();
 }
 
 void DeclareAsCPUThread()
@@ -413,11 +416,18 @@ static void CpuThread()
 
 #ifdef USE_MEMORYWATCHER
 	MemoryWatcher::Init();
+	MemorySnapshot::Init();
 #endif
+	Rewind::Init();
 
 	// Enter CPU run loop. When we leave it - we are done.
 	CPU::Run();
 
+#ifdef USE_MEMORYWATCHER
+	// Frames are captured on this thread, so the ring can only go away once it left the loop.
+	MemorySnapshot::Shutdown();
+#endif
+
 	s_is_started = false;
 
 	if (!_CoreParameter.bCPUThread)
@@ -911,6 +921,7 @@ void Callback_VideoCopiedToXFB(bool video_update)
 		s_drawn_frame++;
 
 	Movie::FrameUpdate();
+	Rewind::FrameUpdate();
 }
 
 void UpdateTitle()
@@ -3,15 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
-#include <mutex>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitHelpers.h"
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
 #include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
@@ -26,10 +28,13 @@
 
 namespace CoreTiming
 {
+static constexpr u32 NO_NODE = UINT32_MAX;
+
 struct EventType
 {
 	TimedCallback callback;
 	const std::string* name;
+	u32 first_pending;  // EventNode in the wheel, so RemoveEvent doesn't have to search
 };
 
 struct Event
@@ -43,11 +48,11 @@ struct Event
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
 static bool operator>(const Event& left, const Event& right)
 {
-	return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
+	return left.time > right.time || (left.time == right.time && left.fifo_order > right.fifo_order);
 }
 static bool operator<(const Event& left, const Event& right)
 {
-	return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
+	return left.time < right.time || (left.time == right.time && left.fifo_order < right.fifo_order);
 }
 
 // unordered_map stores each element separately as a linked list node so pointers to elements
@@ -55,14 +60,65 @@ static bool operator<(const Event& left, const Event& right)
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
+// With the usual handful of pending events, they are kept in s_event_queue, a min-heap, which
+// is the fastest at that size, and RemoveEvent searches it. Past WHEEL_MIN_EVENTS they all move
+// into a timing wheel, and go back to the heap once fewer than HEAP_MAX_EVENTS are left.
 static std::vector<Event> s_event_queue;
+static bool s_use_wheel;
+static constexpr u32 WHEEL_MIN_EVENTS = 64;
+static constexpr u32 HEAP_MAX_EVENTS = 32;
+
+// The wheel has WHEEL_SIZE buckets of 2^WHEEL_BUCKET_SHIFT cycles, starting at the bucket
+// s_wheel_position. Nearly every event is scheduled less than a wheel turn ahead, so it's
+// linked into its bucket in O(1), and finding the next event means finding the first non-empty
+// bucket in s_bucket_mask and its earliest event. The few events further ahead wait in
+// s_overflow, a min-heap, and move into the wheel as it catches up with them. Every overflowed
+// event is later than every event in the wheel.
+//
+// Events are EventNodes in s_nodes, linked by index so the vector can grow. Each node is also
+// in a list of the pending events of its type, which makes RemoveEvent O(1).
+static constexpr int WHEEL_BUCKET_SHIFT = 8;
+static constexpr u32 WHEEL_SIZE = 4096;
+static constexpr u32 WHEEL_MASK = WHEEL_SIZE - 1;
+static constexpr u32 WHEEL_MASK_WORDS = WHEEL_SIZE / 64;
+static constexpr u32 OVERFLOW_BUCKET = WHEEL_SIZE;
+
+struct EventNode
+{
+	Event event;
+	u32 prev;  // In the bucket
+	u32 next;  // In the bucket, or in the free list
+	u32 type_prev;
+	u32 type_next;
+	u32 bucket;  // Or OVERFLOW_BUCKET
+};
+
+static std::vector<EventNode> s_nodes;
+static u32 s_free_nodes = NO_NODE;
+struct Bucket
+{
+	u32 head;
+	u32 tail;
+};
+static std::array<Bucket, WHEEL_SIZE> s_buckets;
+static std::array<u64, WHEEL_MASK_WORDS> s_bucket_mask;
+static s64 s_wheel_position;
+static std::vector<u32> s_overflow;
+static u32 s_pending_count;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::FifoQueue<Event, false> s_ts_queue;
+// The earliest event in the wheel, found again only after it's removed. Advance() looks for the
+// next event before and after running the due ones.
+static u32 s_next_node;
+static bool s_next_node_valid;
+
+// Events scheduled from other threads. This is a lock-free stack, which the CPU thread takes
+// as a whole and reverses to get the events in the order they were scheduled.
+struct ThreadSafeEvent
+{
+	Event event;
+	ThreadSafeEvent* next;
+};
+static std::atomic<ThreadSafeEvent*> s_ts_events{nullptr};
 
 static float s_last_OC_factor;
 float g_last_OC_factor_inverted;
@@ -70,6 +126,7 @@ int g_slice_length;
 static constexpr int MAX_SLICE_LENGTH = 20000;
 
 static s64 s_idled_cycles;
+static u64 s_idle_count;
 static u32 s_fake_dec_start_value;
 static u64 s_fake_dec_start_ticks;
 
@@ -86,6 +143,279 @@ static void EmptyTimedCallback(u64 userdata, s64 cyclesLate)
 {
 }
 
+static bool NodeGreater(u32 left, u32 right)
+{
+	return s_nodes[left].event > s_nodes[right].event;
+}
+
+static bool FitsInWheel(s64 time)
+{
+	return (time >> WHEEL_BUCKET_SHIFT) < s_wheel_position + WHEEL_SIZE;
+}
+
+static void LinkToWheel(u32 index)
+{
+	EventNode& node = s_nodes[index];
+	// Events in the past go to the first bucket, as they are due anyway.
+	const s64 absolute = std::max(node.event.time >> WHEEL_BUCKET_SHIFT, s_wheel_position);
+	const u32 bucket = static_cast<u32>(absolute) & WHEEL_MASK;
+	node.bucket = bucket;
+
+	// Buckets are kept sorted. New events are nearly always the latest in their bucket, so the
+	// search starts from the end.
+	u32 next = NO_NODE;
+	u32 prev = s_buckets[bucket].tail;
+	while (prev != NO_NODE && node.event < s_nodes[prev].event)
+	{
+		next = prev;
+		prev = s_nodes[prev].prev;
+	}
+
+	node.prev = prev;
+	node.next = next;
+	if (next != NO_NODE)
+		s_nodes[next].prev = index;
+	else
+		s_buckets[bucket].tail = index;
+	if (prev != NO_NODE)
+		s_nodes[prev].next = index;
+	else
+		s_buckets[bucket].head = index;
+	s_bucket_mask[bucket / 64] |= 1ULL << (bucket % 64);
+}
+
+static void InsertIntoWheel(const Event& event)
+{
+	u32 index = s_free_nodes;
+	if (index != NO_NODE)
+	{
+		s_free_nodes = s_nodes[index].next;
+	}
+	else
+	{
+		index = static_cast<u32>(s_nodes.size());
+		s_nodes.emplace_back();
+	}
+
+	EventNode& node = s_nodes[index];
+	node.event = event;
+	node.type_prev = NO_NODE;
+	node.type_next = event.type->first_pending;
+	if (node.type_next != NO_NODE)
+		s_nodes[node.type_next].type_prev = index;
+	event.type->first_pending = index;
+
+	if (FitsInWheel(event.time))
+	{
+		LinkToWheel(index);
+	}
+	else
+	{
+		node.bucket = OVERFLOW_BUCKET;
+		s_overflow.push_back(index);
+		std::push_heap(s_overflow.begin(), s_overflow.end(), NodeGreater);
+	}
+	++s_pending_count;
+
+	if (s_next_node_valid && (s_next_node == NO_NODE || event < s_nodes[s_next_node].event))
+		s_next_node = index;
+}
+
+static void UnlinkEvent(u32 index)
+{
+	EventNode& node = s_nodes[index];
+	if (node.bucket == OVERFLOW_BUCKET)
+	{
+		if (s_overflow.front() == index)
+		{
+			std::pop_heap(s_overflow.begin(), s_overflow.end(), NodeGreater);
+			s_overflow.pop_back();
+		}
+		else
+		{
+			s_overflow.erase(std::find(s_overflow.begin(), s_overflow.end(), index));
+			std::make_heap(s_overflow.begin(), s_overflow.end(), NodeGreater);
+		}
+	}
+	else
+	{
+		if (node.prev != NO_NODE)
+			s_nodes[node.prev].next = node.next;
+		else
+			s_buckets[node.bucket].head = node.next;
+		if (node.next != NO_NODE)
+			s_nodes[node.next].prev = node.prev;
+		else
+			s_buckets[node.bucket].tail = node.prev;
+		if (s_buckets[node.bucket].head == NO_NODE)
+			s_bucket_mask[node.bucket / 64] &= ~(1ULL << (node.bucket % 64));
+	}
+
+	if (node.type_prev != NO_NODE)
+		s_nodes[node.type_prev].type_next = node.type_next;
+	else
+		node.event.type->first_pending = node.type_next;
+	if (node.type_next != NO_NODE)
+		s_nodes[node.type_next].type_prev = node.type_prev;
+
+	node.next = s_free_nodes;
+	s_free_nodes = index;
+	--s_pending_count;
+
+	if (index == s_next_node)
+		s_next_node_valid = false;
+}
+
+// Returns the absolute number of the first non-empty bucket, or -1 if the wheel is empty.
+static s64 FindFirstBucket()
+{
+	const u32 start = static_cast<u32>(s_wheel_position) & WHEEL_MASK;
+	u32 word = start / 64;
+	u64 bits = s_bucket_mask[word] & (~0ULL << (start % 64));
+	// After wrapping around, the first word is visited again for the buckets before start.
+	for (u32 i = 0; !bits; ++i)
+	{
+		if (i == WHEEL_MASK_WORDS)
+			return -1;
+		word = (word + 1) % WHEEL_MASK_WORDS;
+		bits = s_bucket_mask[word];
+	}
+
+	const u32 bucket = word * 64 + LeastSignificantSetBit(bits);
+	return s_wheel_position + ((bucket - start) & WHEEL_MASK);
+}
+
+// Returns the node of the earliest pending event, or NO_NODE.
+static u32 FindNextEvent()
+{
+	if (s_next_node_valid)
+		return s_next_node;
+
+	const s64 bucket = FindFirstBucket();
+	if (bucket < 0)
+		s_next_node = s_overflow.empty() ? NO_NODE : s_overflow.front();
+	else
+		s_next_node = s_buckets[static_cast<u32>(bucket) & WHEEL_MASK].head;
+	s_next_node_valid = true;
+	return s_next_node;
+}
+
+// Turns the wheel up to the current time, and moves the overflowed events which now fit into
+// it. There must be no events due anymore, or they would be left behind.
+static void AdvanceWheel()
+{
+	s_wheel_position = std::max(s_wheel_position, g_global_timer >> WHEEL_BUCKET_SHIFT);
+
+	while (!s_overflow.empty() && FitsInWheel(s_nodes[s_overflow.front()].event.time))
+	{
+		std::pop_heap(s_overflow.begin(), s_overflow.end(), NodeGreater);
+		const u32 index = s_overflow.back();
+		s_overflow.pop_back();
+		LinkToWheel(index);
+	}
+}
+
+static void ClearWheel()
+{
+	s_nodes.clear();
+	s_free_nodes = NO_NODE;
+	s_buckets.fill({ NO_NODE, NO_NODE });
+	s_bucket_mask.fill(0);
+	s_wheel_position = g_global_timer >> WHEEL_BUCKET_SHIFT;
+	s_overflow.clear();
+	s_pending_count = 0;
+	s_next_node = NO_NODE;
+	s_next_node_valid = true;
+	for (auto& event_type : s_event_types)
+		event_type.second.first_pending = NO_NODE;
+}
+
+// Pending events, in no particular order.
+static std::vector<Event> GetUnsortedEvents()
+{
+	if (!s_use_wheel)
+		return s_event_queue;
+
+	std::vector<Event> events;
+	events.reserve(s_pending_count);
+	for (const Bucket& bucket : s_buckets)
+	{
+		for (u32 i = bucket.head; i != NO_NODE; i = s_nodes[i].next)
+			events.push_back(s_nodes[i].event);
+	}
+	for (u32 index : s_overflow)
+		events.push_back(s_nodes[index].event);
+	return events;
+}
+
+// Pending events in the order they will run.
+static std::vector<Event> GetPendingEvents()
+{
+	std::vector<Event> events = GetUnsortedEvents();
+	std::sort(events.begin(), events.end());
+	return events;
+}
+
+static void GrowToWheel()
+{
+	ClearWheel();
+	s_use_wheel = true;
+	for (const Event& event : s_event_queue)
+		InsertIntoWheel(event);
+	s_event_queue.clear();
+}
+
+static void InsertEvent(const Event& event)
+{
+	if (!s_use_wheel && s_event_queue.size() < WHEEL_MIN_EVENTS)
+	{
+		s_event_queue.push_back(event);
+		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		return;
+	}
+
+	if (!s_use_wheel)
+		GrowToWheel();
+	InsertIntoWheel(event);
+}
+
+// Moves the events back into the heap once there are few enough. Only done between slices, so
+// that a count hovering around the limit doesn't move them back and forth all the time.
+static void ShrinkToHeap()
+{
+	if (!s_use_wheel || s_pending_count >= HEAP_MAX_EVENTS)
+		return;
+
+	s_event_queue = GetUnsortedEvents();
+	std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+	ClearWheel();
+	s_use_wheel = false;
+}
+
+// Returns the earliest pending event, or nullptr.
+static const Event* PeekNextEvent()
+{
+	if (!s_use_wheel)
+		return s_event_queue.empty() ? nullptr : &s_event_queue.front();
+
+	const u32 index = FindNextEvent();
+	return index != NO_NODE ? &s_nodes[index].event : nullptr;
+}
+
+// Removes the event PeekNextEvent() returned.
+static void PopNextEvent()
+{
+	if (!s_use_wheel)
+	{
+		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		s_event_queue.pop_back();
+	}
+	else
+	{
+		UnlinkEvent(FindNextEvent());
+	}
+}
+
 // Changing the CPU speed in Dolphin isn't actually done by changing the physical clock rate,
 // but by changing the amount of work done in a particular amount of time. This tends to be more
 // compatible because it stops the games from actually knowing directly that the clock rate has
@@ -112,7 +442,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 		"during Init to avoid breaking save states.",
 		name.c_str());
 
-	auto info = s_event_types.emplace(name, EventType{ callback, nullptr });
+	auto info = s_event_types.emplace(name, EventType{ callback, nullptr, NO_NODE });
 	EventType* event_type = &info.first->second;
 	event_type->name = &info.first->first;
 	return event_type;
@@ -120,7 +450,8 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	_assert_msg_(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+	_assert_msg_(POWERPC, s_event_queue.empty() && s_pending_count == 0,
+		"Cannot unregister events with events pending");
 	s_event_types.clear();
 }
 
@@ -132,6 +463,7 @@ void Init()
 	g_slice_length = MAX_SLICE_LENGTH;
 	g_global_timer = 0;
 	s_idled_cycles = 0;
+	s_idle_count = 0;
 
 	// The time between CoreTiming being intialized and the first call to Advance() is considered
 	// the slice boundary between slice -1 and slice 0. Dispatcher loops must call Advance() before
@@ -140,12 +472,12 @@ void Init()
 	s_is_global_timer_sane = true;
 
 	s_event_fifo_id = 0;
+	ClearPendingEvents();
 	s_ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(s_ts_write_lock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
@@ -153,7 +485,6 @@ void Shutdown()
 
 void DoState(PointerWrap& p)
 {
-	std::lock_guard<std::mutex> lk(s_ts_write_lock);
 	p.Do(g_slice_length);
 	p.Do(g_global_timer);
 	p.Do(s_idled_cycles);
@@ -168,7 +499,10 @@ void DoState(PointerWrap& p)
 	p.DoMarker("CoreTimingData");
 
 	MoveEvents();
-	p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+	std::vector<Event> events;
+	if (p.GetMode() != PointerWrap::MODE_READ)
+		events = GetPendingEvents();
+	p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
 		pw.Do(ev.time);
 		pw.Do(ev.fifo_order);
 		// this is why we can't have (nice things) pointers as userdata
@@ -201,10 +535,13 @@ void DoState(PointerWrap& p)
 	p.DoMarker("CoreTimingEvents");
 
 	// When loading from a save state, we must assume the Event order is random and meaningless.
-	// The exact layout of the heap in memory is implementation defined, therefore it is platform
-	// and library version specific.
+	// Older versions saved the layout of a heap, which is implementation defined.
 	if (p.GetMode() == PointerWrap::MODE_READ)
-		std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+	{
+		ClearPendingEvents();
+		for (const Event& ev : events)
+			InsertEvent(ev);
+	}
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -225,9 +562,16 @@ u64 GetIdleTicks()
 	return static_cast<u64>(s_idled_cycles);
 }
 
+u64 GetIdleCount()
+{
+	return s_idle_count;
+}
+
 void ClearPendingEvents()
 {
 	s_event_queue.clear();
+	s_use_wheel = false;
+	ClearWheel();
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -254,8 +598,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 		if (!s_is_global_timer_sane)
 			ForceExceptionCheck(cycles_into_future);
 
-		s_event_queue.emplace_back(Event{ timeout, s_event_fifo_id++, userdata, event_type });
-		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		InsertEvent(Event{ timeout, s_event_fifo_id++, userdata, event_type });
 	}
 	else
 	{
@@ -266,22 +609,34 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 				event_type->name->c_str());
 		}
 
-		std::lock_guard<std::mutex> lk(s_ts_write_lock);
-		s_ts_queue.Push(Event{ g_global_timer + cycles_into_future, 0, userdata, event_type });
+		ThreadSafeEvent* ts_event = new ThreadSafeEvent{
+			Event{ g_global_timer + cycles_into_future, 0, userdata, event_type },
+			s_ts_events.load(std::memory_order_relaxed) };
+		while (!s_ts_events.compare_exchange_weak(ts_event->next, ts_event, std::memory_order_release,
+			std::memory_order_relaxed))
+		{
+		}
 	}
 }
 
 void RemoveEvent(EventType* event_type)
 {
-	auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-		[&](const Event& e) { return e.type == event_type; });
-
-	// Removing random items breaks the invariant so we have to re-establish it.
-	if (itr != s_event_queue.end())
+	if (!s_use_wheel)
 	{
-		s_event_queue.erase(itr, s_event_queue.end());
-		std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
+			[&](const Event& e) { return e.type == event_type; });
+
+		// Removing random items breaks the invariant so we have to re-establish it.
+		if (itr != s_event_queue.end())
+		{
+			s_event_queue.erase(itr, s_event_queue.end());
+			std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		}
+		return;
 	}
+
+	while (event_type->first_pending != NO_NODE)
+		UnlinkEvent(event_type->first_pending);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -294,13 +649,11 @@ void RemoveAllEvents(EventType* event_type)
 void ProcessFifoWaitEvents()
 {
 	MoveEvents();
-	while (!s_event_queue.empty() && s_event_queue.front().time <= g_global_timer)
+	for (const Event* next = PeekNextEvent(); next && next->time <= g_global_timer;
+		next = PeekNextEvent())
 	{
-		Event evt = std::move(s_event_queue.front());
-		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-		s_event_queue.pop_back();
-		// NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
-		//            g_global_timer, evt.time);
+		const Event evt = *next;
+		PopNextEvent();
 		evt.type->callback(evt.userdata, g_global_timer - evt.time);
 	}
 }
@@ -319,11 +672,28 @@ void ForceExceptionCheck(s64 cycles)
 
 void MoveEvents()
 {
-	for (Event ev; s_ts_queue.Pop(ev);)
+	// Checked with a plain load first, as this runs on every Advance() and usually finds nothing.
+	if (!s_ts_events.load(std::memory_order_relaxed))
+		return;
+
+	ThreadSafeEvent* ts_event = s_ts_events.exchange(nullptr, std::memory_order_acquire);
+
+	ThreadSafeEvent* oldest = nullptr;
+	while (ts_event)
 	{
-		ev.fifo_order = s_event_fifo_id++;
-		s_event_queue.emplace_back(std::move(ev));
-		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		ThreadSafeEvent* next = ts_event->next;
+		ts_event->next = oldest;
+		oldest = ts_event;
+		ts_event = next;
+	}
+
+	while (oldest)
+	{
+		ThreadSafeEvent* next = oldest->next;
+		oldest->event.fifo_order = s_event_fifo_id++;
+		InsertEvent(oldest->event);
+		delete oldest;
+		oldest = next;
 	}
 }
 
@@ -339,11 +709,11 @@ void Advance()
 
 	s_is_global_timer_sane = true;
 
-	while (!s_event_queue.empty() && s_event_queue.front().time <= g_global_timer)
+	const Event* next;
+	while ((next = PeekNextEvent()) && next->time <= g_global_timer)
 	{
-		Event evt = std::move(s_event_queue.front());
-		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-		s_event_queue.pop_back();
+		const Event evt = *next;
+		PopNextEvent();
 		// NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
 		//            g_global_timer, evt.time);
 		evt.type->callback(evt.userdata, g_global_timer - evt.time);
@@ -351,11 +721,18 @@ void Advance()
 
 	s_is_global_timer_sane = false;
 
+	if (s_use_wheel)
+	{
+		AdvanceWheel();
+		ShrinkToHeap();
+		next = PeekNextEvent();
+	}
+
 	// Still events left (scheduled in the future)
-	if (!s_event_queue.empty())
+	if (next)
 	{
-		g_slice_length = static_cast<int>(
-			std::min<s64>(s_event_queue.front().time - g_global_timer, MAX_SLICE_LENGTH));
+		g_slice_length =
+			static_cast<int>(std::min<s64>(next->time - g_global_timer, MAX_SLICE_LENGTH));
 	}
 
 	PowerPC::ppcState.downcount = CyclesToDowncount(g_slice_length);
@@ -369,9 +746,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-	auto clone = s_event_queue;
-	std::sort(clone.begin(), clone.end());
-	for (const Event& ev : clone)
+	for (const Event& ev : GetPendingEvents())
 	{
 		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %s", g_global_timer,
 			ev.time, ev.type->name->c_str());
@@ -389,6 +764,7 @@ void Idle()
 	}
 
 	s_idled_cycles += DowncountToCycles(PowerPC::ppcState.downcount);
+	s_idle_count++;
 	PowerPC::ppcState.downcount = 0;
 }
 
@@ -397,9 +773,7 @@ std::string GetScheduledEventsSummary()
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
 
-	auto clone = s_event_queue;
-	std::sort(clone.begin(), clone.end());
-	for (const Event& ev : clone)
+	for (const Event& ev : GetPendingEvents())
 	{
 		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", ev.type->name->c_str(), ev.time,
 			ev.userdata);
@@ -42,6 +42,8 @@ typedef void(*TimedCallback)(u64 userdata, s64 cyclesLate);
 // doing something evil
 u64 GetTicks();
 u64 GetIdleTicks();
+// How many times Idle() was called since Init(). Not saved in savestates.
+u64 GetIdleCount();
 
 void DoState(PointerWrap& p);
 
@@ -9,6 +9,7 @@
 
 #include "Common/Logging/Log.h"
 
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
 
@@ -72,6 +73,56 @@ void Reset()
 	code_flags.fill(0);
 }
 
+// LRS or LR of the high half of either mailbox into one of the accumulator registers.
+bool IsMailboxRead(u16 addr)
+{
+	const UDSPInstruction inst = dsp_imem_read(addr);
+	if ((inst & 0xf8ff) == 0x20fc || (inst & 0xf8ff) == 0x20fe)
+		return true;
+	if ((inst & 0xffe0) == 0x00c0 && (inst & 0x1f) >= DSP_REG_AXL0)
+	{
+		const u16 mem = dsp_imem_read(addr + 1);
+		return mem == (0xff00 | DSP_DMBH) || mem == (0xff00 | DSP_CMBH);
+	}
+	return false;
+}
+
+// ANDF and ANDCF only touch SR.
+bool IsFlagTest(UDSPInstruction inst)
+{
+	return (inst & 0xfeff) == 0x02a0 || (inst & 0xfeff) == 0x02c0;
+}
+
+// Catches the mail wait loops the signatures don't know about: a mailbox read followed by
+// nothing but flag tests and a conditional jump back to the read. Such a loop has no side
+// effects, so it can be skipped for as long as the mailbox doesn't change.
+void FindMailWaitLoops(u16 start_addr, u16 end_addr)
+{
+	for (u16 addr = start_addr; addr < end_addr; addr++)
+	{
+		const UDSPInstruction inst = dsp_imem_read(addr);
+		if (!(code_flags[addr] & CODE_START_OF_INST) || (inst & 0xfff0) != 0x0290 || inst == 0x029f)
+			continue;
+
+		const u16 loop_start = dsp_imem_read(addr + 1);
+		if (loop_start >= addr || addr - loop_start > 4 ||
+			!(code_flags[loop_start] & CODE_START_OF_INST) || !IsMailboxRead(loop_start))
+		{
+			continue;
+		}
+
+		u16 pc = loop_start + GetOpTemplate(dsp_imem_read(loop_start))->size;
+		while (pc < addr && IsFlagTest(dsp_imem_read(pc)))
+			pc += 2;
+
+		if (pc == addr && !(code_flags[loop_start] & CODE_IDLE_SKIP))
+		{
+			INFO_LOG(DSPLLE, "Mail wait loop found at %04x", loop_start);
+			code_flags[loop_start] |= CODE_IDLE_SKIP;
+		}
+	}
+}
+
 void AnalyzeRange(u16 start_addr, u16 end_addr)
 {
 	// First we run an extremely simplified version of a disassembler to find
@@ -149,6 +200,7 @@ void AnalyzeRange(u16 start_addr, u16 end_addr)
 			}
 		}
 	}
+	FindMailWaitLoops(start_addr, end_addr);
 	INFO_LOG(DSPLLE, "Finished analysis.");
 }
 }  // Anonymous namespace
@@ -5,11 +5,13 @@
 #include "Core/DSP/Jit/DSPEmitter.h"
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstring>
 
 #include "Common/Assert.h"
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 
 #include "Core/DSP/DSPAnalyzer.h"
@@ -18,9 +20,10 @@
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
 
-constexpr size_t COMPILED_CODE_SIZE = 2097152;
+constexpr size_t COMPILED_CODE_SIZE = 4194304;
+// Once less than this is left, the whole code space is thrown away after the current slice.
+constexpr size_t CODE_SPACE_RESERVE = COMPILED_CODE_SIZE / 4;
 constexpr size_t MAX_BLOCK_SIZE = 250;
-constexpr u16 DSP_IDLE_SKIP_CYCLES = 0x1000;
 
 using namespace Gen;
 
@@ -35,6 +38,8 @@ DSPEmitter::DSPEmitter()
 
 	// Clear all of the block references
 	std::fill(blocks.begin(), blocks.end(), (DSPCompiledCode)stubEntryPoint);
+
+	iramHash = GetMurmurHash3(reinterpret_cast<const u8*>(g_dsp.iram), DSP_IRAM_BYTE_SIZE, 0);
 }
 
 DSPEmitter::~DSPEmitter()
@@ -42,16 +47,58 @@ DSPEmitter::~DSPEmitter()
 	FreeCodeSpace();
 }
 
-void DSPEmitter::ClearIRAM()
+void DSPEmitter::ResetBlocks()
 {
-	for (int i = 0x0000; i < 0x1000; i++)
+	for (size_t i = 0; i < MAX_BLOCKS; i++)
 	{
 		blocks[i] = (DSPCompiledCode)stubEntryPoint;
 		blockLinks[i] = nullptr;
 		blockSize[i] = 0;
 		unresolvedJumps[i].clear();
 	}
-	g_dsp.reset_dspjit_codespace = true;
+}
+
+void DSPEmitter::SwitchUCode()
+{
+	const u64 hash = GetMurmurHash3(reinterpret_cast<const u8*>(g_dsp.iram), DSP_IRAM_BYTE_SIZE, 0);
+	if (hash == iramHash)
+		return;
+
+	// ROM blocks can link into IRAM blocks, so they are stashed along with them.
+	std::vector<CachedBlock>& old_blocks = cachedUCodes[iramHash];
+	old_blocks.clear();
+	for (size_t i = 0; i < MAX_BLOCKS; i++)
+	{
+		if (blocks[i] != (DSPCompiledCode)stubEntryPoint || !unresolvedJumps[i].empty())
+		{
+			old_blocks.push_back({ static_cast<u16>(i), blocks[i], blockLinks[i], blockSize[i],
+				std::move(unresolvedJumps[i]) });
+		}
+	}
+	if (old_blocks.empty())
+		cachedUCodes.erase(iramHash);
+
+	ResetBlocks();
+
+	auto cached = cachedUCodes.find(hash);
+	if (cached != cachedUCodes.end())
+	{
+		for (CachedBlock& block : cached->second)
+		{
+			blocks[block.address] = block.code;
+			blockLinks[block.address] = block.link;
+			blockSize[block.address] = block.size;
+			unresolvedJumps[block.address] = std::move(block.unresolved_jumps);
+		}
+		cachedUCodes.erase(cached);
+		INFO_LOG(DSPLLE, "Reusing compiled blocks of ucode %016" PRIx64, hash);
+	}
+	iramHash = hash;
+
+	// The old code may still be running, so the code space can only be cleared
+	// once the dispatcher returns.
+	if (GetSpaceLeft() < CODE_SPACE_RESERVE)
+		g_dsp.reset_dspjit_codespace = true;
 }
 
 void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
@@ -60,13 +107,8 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
 	CompileDispatcher();
 	stubEntryPoint = CompileStub();
 
-	for (int i = 0x0000; i < 0x10000; i++)
-	{
-		blocks[i] = (DSPCompiledCode)stubEntryPoint;
-		blockLinks[i] = nullptr;
-		blockSize[i] = 0;
-		unresolvedJumps[i].clear();
-	}
+	ResetBlocks();
+	cachedUCodes.clear();
 	g_dsp.reset_dspjit_codespace = false;
 }
 
@@ -254,16 +296,7 @@ void DSPEmitter::Compile(u16 start_addr)
 			DSPJitRegCache c(gpr);
 			HandleLoop();
 			gpr.SaveRegs();
-			if (!DSPHost::OnThread() &&
-				DSPAnalyzer::GetCodeFlags(start_addr) & DSPAnalyzer::CODE_IDLE_SKIP)
-			{
-				MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-			}
-			else
-			{
-				MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-			}
-			JMP(returnDispatcher, true);
+			WriteBlockExit();
 			gpr.LoadRegs(false);
 			gpr.FlushRegs(c, false);
 
@@ -289,16 +322,7 @@ void DSPEmitter::Compile(u16 start_addr)
 				DSPJitRegCache c(gpr);
 				// don't update g_dsp.pc -- the branch insn already did
 				gpr.SaveRegs();
-				if (!DSPHost::OnThread() &&
-					DSPAnalyzer::GetCodeFlags(start_addr) & DSPAnalyzer::CODE_IDLE_SKIP)
-				{
-					MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-				}
-				else
-				{
-					MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-				}
-				JMP(returnDispatcher, true);
+				WriteBlockExit();
 				gpr.LoadRegs(false);
 				gpr.FlushRegs(c, false);
 
@@ -353,15 +377,27 @@ void DSPEmitter::Compile(u16 start_addr)
 	}
 
 	gpr.SaveRegs();
-	if (!DSPHost::OnThread() && DSPAnalyzer::GetCodeFlags(start_addr) & DSPAnalyzer::CODE_IDLE_SKIP)
+	WriteBlockExit();
+
+	// Anything compiled from here on may already be linked to, so the code space can't be
+	// cleared before the dispatcher returns.
+	if (GetSpaceLeft() < CODE_SPACE_RESERVE)
+		g_dsp.reset_dspjit_codespace = true;
+}
+
+void DSPEmitter::WriteBlockExit()
+{
+	// Mail wait loops don't do anything until the CPU side catches up, so they
+	// fast-forward to the end of the slice instead of spinning through it.
+	if (DSPAnalyzer::GetCodeFlags(startAddr) & DSPAnalyzer::CODE_IDLE_SKIP)
 	{
-		MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
+		JMP(idleDispatcher, true);
 	}
 	else
 	{
-		MOV(16, R(EAX), Imm16(blockSize[start_addr]));
+		MOV(16, R(EAX), Imm16(blockSize[startAddr]));
+		JMP(returnDispatcher, true);
 	}
-	JMP(returnDispatcher, true);
 }
 
 const u8* DSPEmitter::CompileStub()
@@ -404,8 +440,13 @@ void DSPEmitter::CompileDispatcher()
 	SUB(16, M(&g_cycles_left), R(EAX));
 
 	J_CC(CC_A, dispatcherLoop);
+	FixupBranch outOfCycles = J();
 
 	// DSP gave up the remaining cycles.
+	idleDispatcher = GetCodePtr();
+	MOV(16, M(&g_cycles_left), Imm16(0));
+
+	SetJumpTarget(outOfCycles);
 	SetJumpTarget(_halt);
 	if (DSPHost::OnThread())
 	{
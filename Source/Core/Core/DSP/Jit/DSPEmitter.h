@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <list>
+#include <map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -27,7 +28,9 @@ public:
 	~DSPEmitter();
 
 	void EmitInstruction(UDSPInstruction inst);
-	void ClearIRAM();
+	// Called whenever IRAM changes. Stashes the blocks compiled for the old ucode and brings
+	// back the ones of the new ucode if it was already run before.
+	void SwitchUCode();
 	void ClearIRAMandDSPJITCodespaceReset();
 
 	void CompileDispatcher();
@@ -37,6 +40,8 @@ public:
 	bool FlagsNeeded() const;
 
 	void FallBackToInterpreter(UDSPInstruction inst);
+	// Leaves the current block. Idle loops give up the rest of the time slice.
+	void WriteBlockExit();
 
 	// CC Util
 	void Update_SR_Register64(Gen::X64Reg val = Gen::EAX);
@@ -243,6 +248,7 @@ public:
 	const u8* reenterDispatcher;
 	const u8* stubEntryPoint;
 	const u8* returnDispatcher;
+	const u8* idleDispatcher;
 	u16 compilePC;
 	u16 startAddr;
 	std::vector<Block> blockLinks;
@@ -252,10 +258,26 @@ public:
 	DSPJitRegCache gpr{ *this };
 
 private:
+	struct CachedBlock
+	{
+		u16 address;
+		DSPCompiledCode code;
+		Block link;
+		u16 size;
+		std::list<u16> unresolved_jumps;
+	};
+
+	void ResetBlocks();
+
 	std::vector<DSPCompiledCode> blocks;
 	Block blockLinkEntry;
 	u16 compileSR;
 
+	// Compiled blocks of the ucodes that were swapped out, keyed by the hash of IRAM.
+	// The code itself stays in the code space until it runs full.
+	std::map<u64, std::vector<CachedBlock>> cachedUCodes;
+	u64 iramHash = 0;
+
 	// The index of the last stored ext value (compile time).
 	int storeIndex = -1;
 	int storeIndex2 = -1;
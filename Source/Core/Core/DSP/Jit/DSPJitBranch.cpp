@@ -4,7 +4,6 @@
 
 #include "Common/CommonTypes.h"
 
-#include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
@@ -81,15 +80,7 @@ static void WriteBranchExit(DSPEmitter& emitter)
 {
 	DSPJitRegCache c(emitter.gpr);
 	emitter.gpr.SaveRegs();
-	if (DSPAnalyzer::GetCodeFlags(emitter.startAddr) & DSPAnalyzer::CODE_IDLE_SKIP)
-	{
-		emitter.MOV(16, R(EAX), Imm16(0x1000));
-	}
-	else
-	{
-		emitter.MOV(16, R(EAX), Imm16(emitter.blockSize[emitter.startAddr]));
-	}
-	emitter.JMP(emitter.returnDispatcher, true);
+	emitter.WriteBlockExit();
 	emitter.gpr.LoadRegs(false);
 	emitter.gpr.FlushRegs(c, false);
 }
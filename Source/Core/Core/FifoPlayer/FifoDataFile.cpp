@@ -3,12 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <zlib.h>
 
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
+#include "Core/FifoPlayer/FifoMemoryStore.h"
 
 using namespace FifoFileStruct;
 
@@ -37,21 +42,101 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-	m_Frames.push_back(frameInfo);
+	std::lock_guard<std::mutex> lk(m_FrameMutex);
+	m_Frames.push_back(std::make_shared<FifoFrameInfo>(frameInfo));
 }
 
-bool FifoDataFile::Save(const std::string& filename)
+u32 FifoDataFile::GetFrameCount() const
+{
+	std::lock_guard<std::mutex> lk(m_FrameMutex);
+	if (!m_FrameIndex.empty())
+		return static_cast<u32>(m_FrameIndex.size());
+	return static_cast<u32>(m_Frames.size());
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
+{
+	std::lock_guard<std::mutex> lk(m_FrameMutex);
+
+	if (m_FrameIndex.empty())
+		return m_Frames[frame];
+
+	for (auto it = m_FrameCache.begin(); it != m_FrameCache.end(); ++it)
+	{
+		if (it->first == frame)
+		{
+			// Move to the front so the least recently used frame is evicted first
+			std::rotate(m_FrameCache.begin(), it, it + 1);
+			return m_FrameCache.front().second;
+		}
+	}
+
+	std::shared_ptr<const FifoFrameInfo> frameInfo = ReadFrame(frame);
+
+	if (m_FrameCache.size() >= FRAME_CACHE_SIZE)
+		m_FrameCache.pop_back();
+	m_FrameCache.emplace(m_FrameCache.begin(), frame, frameInfo);
+
+	return frameInfo;
+}
+
+void FifoDataFile::PrefetchFrame(u32 frame) const
+{
+	if (frame >= m_FrameIndex.size() || !m_MappedFile.IsOpen())
+		return;
+
+	const FileFrameInfo& srcFrame = m_FrameIndex[frame];
+	if (srcFrame.frameFlags & FRAME_FLAG_COMPRESSED)
+	{
+		m_MappedFile.Prefetch(srcFrame.payloadOffset, srcFrame.payloadCompressedSize);
+	}
+	else
+	{
+		// Memory update data is written right after the FIFO data, up to the update list
+		if (srcFrame.memoryUpdatesOffset > srcFrame.fifoDataOffset)
+			m_MappedFile.Prefetch(srcFrame.fifoDataOffset,
+				srcFrame.memoryUpdatesOffset - srcFrame.fifoDataOffset);
+		else
+			m_MappedFile.Prefetch(srcFrame.fifoDataOffset, srcFrame.fifoDataSize);
+	}
+
+	m_MappedFile.Prefetch(srcFrame.memoryUpdatesOffset,
+		srcFrame.numMemoryUpdates * sizeof(FileMemoryUpdate));
+}
+
+// Returns false if compressing doesn't make the data any smaller
+static bool CompressData(const u8* data, size_t size, std::vector<u8>& compressed)
+{
+	if (size == 0 || size > UINT32_MAX)
+		return false;
+
+	uLongf compressedSize = compressBound(static_cast<uLong>(size));
+	compressed.resize(compressedSize);
+	if (compress2(compressed.data(), &compressedSize, data, static_cast<uLong>(size),
+		Z_DEFAULT_COMPRESSION) != Z_OK || compressedSize >= size)
+	{
+		compressed.clear();
+		return false;
+	}
+
+	compressed.resize(compressedSize);
+	return true;
+}
+
+bool FifoDataFile::Save(const std::string& filename, bool compress)
 {
 	File::IOFile file;
 	if (!file.Open(filename, "wb"))
 		return false;
 
+	const u32 frameCount = GetFrameCount();
+
 	// Add space for header
 	PadFile(sizeof(FileHeader), file);
 
 	// Add space for frame list
 	u64 frameListOffset = file.Tell();
-	PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
+	PadFile(frameCount * sizeof(FileFrameInfo), file);
 
 	u64 bpMemOffset = file.Tell();
 	file.WriteArray(m_BPMem, BP_MEM_SIZE);
@@ -68,11 +153,162 @@ bool FifoDataFile::Save(const std::string& filename)
 	u64 texMemOffset = file.Tell();
 	file.WriteArray(m_TexMem, TEX_MEM_SIZE);
 
+	bool hasCompressedFrames = false;
+
+	// Every memory update's data is interned, so identical blocks map to the same pointer
+	FifoMemoryStore store;
+	std::unordered_map<const std::vector<u8>*, u32> useCounts;
+	std::unordered_map<const std::vector<u8>*, u64> writtenOffsets;
+	std::unordered_map<const std::vector<u8>*, u32> chunkIndices;
+	std::vector<FileMemoryChunk> chunks;
+
+	if (compress)
+	{
+		// Blocks used more than once go to the chunk table so that they don't end up in
+		// several compressed payloads
+		for (u32 i = 0; i < frameCount; ++i)
+		{
+			const std::shared_ptr<const FifoFrameInfo> srcFrame = GetFrame(i);
+			for (const MemoryUpdate& update : srcFrame->memoryUpdates)
+				++useCounts[store.Intern(update.data).get()];
+		}
+	}
+
+	// Write frames list
+	for (u32 i = 0; i < frameCount; ++i)
+	{
+		const std::shared_ptr<const FifoFrameInfo> srcFrame = GetFrame(i);
+		const size_t numUpdates = srcFrame->memoryUpdates.size();
+
+		FileFrameInfo dstFrame;
+		std::memset(&dstFrame, 0, sizeof(FileFrameInfo));
+		dstFrame.fifoDataSize = static_cast<u32>(srcFrame->fifoData.size());
+		dstFrame.fifoStart = srcFrame->fifoStart;
+		dstFrame.fifoEnd = srcFrame->fifoEnd;
+		dstFrame.numMemoryUpdates = static_cast<u32>(numUpdates);
+
+		std::vector<u64> dataOffsets(numUpdates);
+		std::vector<u8> updateFlags(numUpdates, 0);
+
+		if (compress)
+		{
+			// The payload is the FIFO data followed by the data of each unshared memory update
+			std::vector<u8> payload(srcFrame->fifoData);
+			for (size_t j = 0; j < numUpdates; ++j)
+			{
+				const FifoMemoryStore::Block block = store.Intern(srcFrame->memoryUpdates[j].data);
+				if (useCounts[block.get()] > 1)
+				{
+					auto it = chunkIndices.find(block.get());
+					if (it == chunkIndices.end())
+					{
+						FileMemoryChunk chunk;
+						std::vector<u8> compressed;
+						file.Seek(0, SEEK_END);
+						chunk.dataOffset = file.Tell();
+						chunk.dataSize = static_cast<u32>(block->size());
+						if (CompressData(block->data(), block->size(), compressed))
+						{
+							chunk.compressedSize = static_cast<u32>(compressed.size());
+							file.WriteBytes(compressed.data(), compressed.size());
+						}
+						else
+						{
+							chunk.compressedSize = 0;
+							file.WriteBytes(block->data(), block->size());
+						}
+
+						it = chunkIndices.emplace(block.get(), static_cast<u32>(chunks.size())).first;
+						chunks.push_back(chunk);
+					}
+
+					dataOffsets[j] = it->second;
+					updateFlags[j] = MEMORY_UPDATE_FLAG_CHUNK;
+				}
+				else
+				{
+					dataOffsets[j] = payload.size();
+					payload.insert(payload.end(), block->begin(), block->end());
+				}
+			}
+
+			std::vector<u8> compressed;
+			file.Seek(0, SEEK_END);
+			u64 payloadOffset = file.Tell();
+
+			if (CompressData(payload.data(), payload.size(), compressed))
+			{
+				file.WriteBytes(compressed.data(), compressed.size());
+
+				dstFrame.frameFlags = FRAME_FLAG_COMPRESSED;
+				dstFrame.payloadOffset = payloadOffset;
+				dstFrame.payloadCompressedSize = static_cast<u32>(compressed.size());
+				dstFrame.payloadSize = static_cast<u32>(payload.size());
+				dstFrame.fifoDataOffset = 0;
+				hasCompressedFrames = true;
+			}
+			else
+			{
+				// Not worth it, store the frame uncompressed
+				file.WriteBytes(payload.data(), payload.size());
+
+				dstFrame.fifoDataOffset = payloadOffset;
+				for (size_t j = 0; j < numUpdates; ++j)
+				{
+					if (!(updateFlags[j] & MEMORY_UPDATE_FLAG_CHUNK))
+						dataOffsets[j] += payloadOffset;
+				}
+			}
+		}
+		else
+		{
+			file.Seek(0, SEEK_END);
+			dstFrame.fifoDataOffset = file.Tell();
+			file.WriteBytes(srcFrame->fifoData.data(), srcFrame->fifoData.size());
+
+			// Identical blocks point at the copy written first, which any loader version handles
+			for (size_t j = 0; j < numUpdates; ++j)
+			{
+				const FifoMemoryStore::Block block = store.Intern(srcFrame->memoryUpdates[j].data);
+				auto it = writtenOffsets.find(block.get());
+				if (it == writtenOffsets.end())
+				{
+					it = writtenOffsets.emplace(block.get(), file.Tell()).first;
+					file.WriteBytes(block->data(), block->size());
+				}
+
+				dataOffsets[j] = it->second;
+			}
+		}
+
+		dstFrame.memoryUpdatesOffset =
+			WriteMemoryUpdates(srcFrame->memoryUpdates, dataOffsets, updateFlags, file);
+
+		// Write frame info
+		u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
+		file.Seek(frameOffset, SEEK_SET);
+		file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
+	}
+
+	// Write chunk table
+	u64 chunkTableOffset = 0;
+	if (!chunks.empty())
+	{
+		file.Seek(0, SEEK_END);
+		chunkTableOffset = file.Tell();
+		file.WriteArray(chunks.data(), chunks.size());
+	}
+
 	// Write header
 	FileHeader header;
 	header.fileId = FILE_ID;
 	header.file_version = VERSION_NUMBER;
-	header.min_loader_version = MIN_LOADER_VERSION;
+	if (!chunks.empty())
+		header.min_loader_version = MIN_LOADER_VERSION_CHUNKS;
+	else if (hasCompressedFrames)
+		header.min_loader_version = MIN_LOADER_VERSION_COMPRESSED;
+	else
+		header.min_loader_version = MIN_LOADER_VERSION;
 
 	header.bpMemOffset = bpMemOffset;
 	header.bpMemSize = BP_MEM_SIZE;
@@ -90,39 +326,16 @@ bool FifoDataFile::Save(const std::string& filename)
 	header.texMemSize = TEX_MEM_SIZE;
 
 	header.frameListOffset = frameListOffset;
-	header.frameCount = (u32)m_Frames.size();
+	header.frameCount = frameCount;
 
 	header.flags = m_Flags;
 
+	header.chunkTableOffset = chunkTableOffset;
+	header.chunkCount = static_cast<u32>(chunks.size());
+
 	file.Seek(0, SEEK_SET);
 	file.WriteBytes(&header, sizeof(FileHeader));
 
-	// Write frames list
-	for (unsigned int i = 0; i < m_Frames.size(); ++i)
-	{
-		const FifoFrameInfo& srcFrame = m_Frames[i];
-
-		// Write FIFO data
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-		FileFrameInfo dstFrame;
-		dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-		dstFrame.fifoDataOffset = dataOffset;
-		dstFrame.fifoStart = srcFrame.fifoStart;
-		dstFrame.fifoEnd = srcFrame.fifoEnd;
-		dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-		dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
-
-		// Write frame info
-		u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
-	}
-
 	if (!file.Close())
 		return false;
 
@@ -181,31 +394,116 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
 		file.ReadArray(dataFile->m_TexMem, size);
 	}
 
-	// Read frames
-	for (u32 i = 0; i < header.frameCount; ++i)
+	// Only the frame index is read up front, frames are streamed from the file by GetFrame.
+	dataFile->m_FrameIndex.resize(header.frameCount);
+	file.Seek(header.frameListOffset, SEEK_SET);
+	if (!file.ReadArray(dataFile->m_FrameIndex.data(), header.frameCount))
 	{
-		u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		FileFrameInfo srcFrame;
-		file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
+		ERROR_LOG(VIDEO, "FIFO log %s has a truncated frame list", filename.c_str());
+		return nullptr;
+	}
+
+	// Per-frame compression was added in version 5.
+	if (dataFile->m_Version < 5)
+	{
+		for (FileFrameInfo& frame : dataFile->m_FrameIndex)
+			frame.frameFlags = 0;
+	}
 
-		FifoFrameInfo dstFrame;
-		dstFrame.fifoData.resize(srcFrame.fifoDataSize);
-		dstFrame.fifoStart = srcFrame.fifoStart;
-		dstFrame.fifoEnd = srcFrame.fifoEnd;
+	// Shared memory update chunks were added in version 6.
+	if (dataFile->m_Version >= 6 && header.chunkCount > 0)
+	{
+		dataFile->m_Chunks.resize(header.chunkCount);
+		file.Seek(header.chunkTableOffset, SEEK_SET);
+		if (!file.ReadArray(dataFile->m_Chunks.data(), header.chunkCount))
+		{
+			ERROR_LOG(VIDEO, "FIFO log %s has a truncated chunk table", filename.c_str());
+			return nullptr;
+		}
+		dataFile->m_ChunkData.resize(header.chunkCount);
+	}
+
+	if (dataFile->m_MappedFile.Open(filename))
+		file.Close();
+	else
+		dataFile->m_FileHandle = std::move(file);
+
+	return dataFile;
+}
 
-		file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-		file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
+bool FifoDataFile::ReadFileData(u64 offset, u64 size, u8* out) const
+{
+	if (size == 0)
+		return true;
+
+	if (m_MappedFile.IsOpen())
+		return m_MappedFile.Read(offset, size, out);
+
+	m_FileHandle.Seek(offset, SEEK_SET);
+	if (m_FileHandle.ReadBytes(out, size))
+		return true;
+
+	m_FileHandle.Clear();
+	return false;
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::ReadFrame(u32 frame) const
+{
+	auto dstFrame = std::make_shared<FifoFrameInfo>();
+	if (frame >= m_FrameIndex.size())
+		return dstFrame;
 
-		ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-			dstFrame.memoryUpdates, file);
+	const FileFrameInfo& srcFrame = m_FrameIndex[frame];
+	dstFrame->fifoStart = srcFrame.fifoStart;
+	dstFrame->fifoEnd = srcFrame.fifoEnd;
 
-		dataFile->AddFrame(dstFrame);
+	std::vector<u8> payload;
+	if (srcFrame.frameFlags & FRAME_FLAG_COMPRESSED)
+	{
+		const u8* compressed = m_MappedFile.GetPointer(srcFrame.payloadOffset,
+			srcFrame.payloadCompressedSize);
+		std::vector<u8> compressedCopy;
+		if (!compressed)
+		{
+			compressedCopy.resize(srcFrame.payloadCompressedSize);
+			if (ReadFileData(srcFrame.payloadOffset, compressedCopy.size(), compressedCopy.data()))
+				compressed = compressedCopy.data();
+		}
+
+		payload.resize(srcFrame.payloadSize);
+		uLongf payloadSize = srcFrame.payloadSize;
+		if (!compressed ||
+			uncompress(payload.data(), &payloadSize, compressed, srcFrame.payloadCompressedSize) !=
+			Z_OK ||
+			payloadSize != srcFrame.payloadSize ||
+			static_cast<u64>(srcFrame.fifoDataOffset) + srcFrame.fifoDataSize > payloadSize)
+		{
+			ERROR_LOG(VIDEO, "Failed to decompress FIFO log frame %u", frame);
+			return dstFrame;
+		}
+
+		dstFrame->fifoData.assign(payload.begin() + srcFrame.fifoDataOffset,
+			payload.begin() + srcFrame.fifoDataOffset + srcFrame.fifoDataSize);
+	}
+	else
+	{
+		dstFrame->fifoData.resize(srcFrame.fifoDataSize);
+		if (!ReadFileData(srcFrame.fifoDataOffset, srcFrame.fifoDataSize, dstFrame->fifoData.data()))
+		{
+			ERROR_LOG(VIDEO, "Failed to read FIFO log frame %u", frame);
+			dstFrame->fifoData.clear();
+			return dstFrame;
+		}
 	}
 
-	file.Close();
+	if (!ReadMemoryUpdates(srcFrame, payload.empty() ? nullptr : payload.data(),
+		dstFrame->memoryUpdates))
+	{
+		ERROR_LOG(VIDEO, "Failed to read memory updates of FIFO log frame %u", frame);
+		dstFrame->memoryUpdates.clear();
+	}
 
-	return dataFile;
+	return dstFrame;
 }
 
 void FifoDataFile::PadFile(size_t numBytes, File::IOFile& file)
@@ -228,55 +526,111 @@ bool FifoDataFile::GetFlag(u32 flag) const
 }
 
 u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-	File::IOFile& file)
+	const std::vector<u64>& dataOffsets, const std::vector<u8>& updateFlags, File::IOFile& file)
 {
-	// Add space for memory update list
+	file.Seek(0, SEEK_END);
 	u64 updateListOffset = file.Tell();
-	PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
 
-	for (unsigned int i = 0; i < memUpdates.size(); ++i)
+	std::vector<FileMemoryUpdate> dstUpdates(memUpdates.size());
+	for (size_t i = 0; i < memUpdates.size(); ++i)
 	{
 		const MemoryUpdate& srcUpdate = memUpdates[i];
 
-		// Write memory
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
-
-		FileMemoryUpdate dstUpdate;
+		FileMemoryUpdate& dstUpdate = dstUpdates[i];
+		std::memset(&dstUpdate, 0, sizeof(FileMemoryUpdate));
 		dstUpdate.address = srcUpdate.address;
-		dstUpdate.dataOffset = dataOffset;
-		dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
+		dstUpdate.dataOffset = dataOffsets[i];
+		dstUpdate.dataSize = static_cast<u32>(srcUpdate.data->size());
 		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
 		dstUpdate.type = srcUpdate.type;
-
-		u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
-		file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
+		dstUpdate.flags = updateFlags[i];
 	}
 
+	file.WriteArray(dstUpdates.data(), dstUpdates.size());
+
 	return updateListOffset;
 }
 
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-	std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
+std::shared_ptr<const std::vector<u8>> FifoDataFile::ReadChunk(u32 chunk) const
+{
+	if (chunk >= m_Chunks.size())
+		return nullptr;
+
+	std::shared_ptr<const std::vector<u8>> data = m_ChunkData[chunk].lock();
+	if (data)
+		return data;
+
+	const FileMemoryChunk& srcChunk = m_Chunks[chunk];
+	// Not make_shared, the memory should be released as soon as no frame uses the chunk
+	std::vector<u8>* dstData = new std::vector<u8>(srcChunk.dataSize);
+	data.reset(dstData);
+
+	if (srcChunk.compressedSize == 0)
+	{
+		if (!ReadFileData(srcChunk.dataOffset, srcChunk.dataSize, dstData->data()))
+			return nullptr;
+	}
+	else
+	{
+		std::vector<u8> compressed(srcChunk.compressedSize);
+		uLongf dataSize = srcChunk.dataSize;
+		if (!ReadFileData(srcChunk.dataOffset, compressed.size(), compressed.data()) ||
+			uncompress(dstData->data(), &dataSize, compressed.data(), srcChunk.compressedSize) !=
+			Z_OK ||
+			dataSize != srcChunk.dataSize)
+		{
+			return nullptr;
+		}
+	}
+
+	m_ChunkData[chunk] = data;
+	return data;
+}
+
+bool FifoDataFile::ReadMemoryUpdates(const FileFrameInfo& srcFrame, const u8* payload,
+	std::vector<MemoryUpdate>& memUpdates) const
 {
-	memUpdates.resize(numUpdates);
+	std::vector<FileMemoryUpdate> srcUpdates(srcFrame.numMemoryUpdates);
+	if (!ReadFileData(srcFrame.memoryUpdatesOffset,
+		srcUpdates.size() * sizeof(FileMemoryUpdate),
+		reinterpret_cast<u8*>(srcUpdates.data())))
+	{
+		return false;
+	}
 
-	for (u32 i = 0; i < numUpdates; ++i)
+	memUpdates.resize(srcUpdates.size());
+
+	for (size_t i = 0; i < srcUpdates.size(); ++i)
 	{
-		u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
-		FileMemoryUpdate srcUpdate;
-		file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
+		const FileMemoryUpdate& srcUpdate = srcUpdates[i];
 
 		MemoryUpdate& dstUpdate = memUpdates[i];
 		dstUpdate.address = srcUpdate.address;
 		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-		dstUpdate.data.resize(srcUpdate.dataSize);
 		dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
 
-		file.Seek(srcUpdate.dataOffset, SEEK_SET);
-		file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
+		if (m_Version >= 6 && (srcUpdate.flags & MEMORY_UPDATE_FLAG_CHUNK))
+		{
+			dstUpdate.data = ReadChunk(static_cast<u32>(srcUpdate.dataOffset));
+			if (!dstUpdate.data || dstUpdate.data->size() != srcUpdate.dataSize)
+				return false;
+			continue;
+		}
+
+		auto data = std::make_shared<std::vector<u8>>(srcUpdate.dataSize);
+		dstUpdate.data = data;
+
+		if (payload)
+		{
+			if (srcUpdate.dataOffset + srcUpdate.dataSize > srcFrame.payloadSize)
+				return false;
+			std::copy_n(payload + srcUpdate.dataOffset, srcUpdate.dataSize, data->begin());
+		}
+		else if (!ReadFileData(srcUpdate.dataOffset, srcUpdate.dataSize, data->data()))
+		{
+			return false;
+		}
 	}
+
+	return true;
 }
@@ -5,15 +5,15 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
-
-namespace File
-{
-class IOFile;
-}
+#include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
+#include "Core/FifoPlayer/FifoFileStruct.h"
 
 struct MemoryUpdate
 {
@@ -27,7 +27,8 @@ struct MemoryUpdate
 
 	u32 fifoPosition;
 	u32 address;
-	std::vector<u8> data;
+	// Shared between all updates with identical contents, see FifoMemoryStore
+	std::shared_ptr<const std::vector<u8>> data;
 	Type type;
 };
 
@@ -67,9 +68,18 @@ public:
 	u32* GetXFRegs() { return m_XFRegs; }
 	u8* GetTexMem() { return m_TexMem; }
 	void AddFrame(const FifoFrameInfo& frameInfo);
-	const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
-	u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
-	bool Save(const std::string& filename);
+
+	// Frames of a loaded file are read from disk on demand and only the most recently used ones
+	// are kept in memory, so don't hold on to the returned frame longer than needed.
+	std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
+	u32 GetFrameCount() const;
+
+	// Hints the OS to page in a frame of a loaded file ahead of GetFrame. Never blocks.
+	void PrefetchFrame(u32 frame) const;
+
+	// If compress is set, each frame's payload is zlib compressed when that makes it smaller.
+	// Files with compressed frames can't be opened by loaders older than version 5.
+	bool Save(const std::string& filename, bool compress = false);
 
 	static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
@@ -79,14 +89,25 @@ private:
 		FLAG_IS_WII = 1
 	};
 
+	enum
+	{
+		FRAME_CACHE_SIZE = 8
+	};
+
 	void PadFile(size_t numBytes, File::IOFile& file);
 
 	void SetFlag(u32 flag, bool set);
 	bool GetFlag(u32 flag) const;
 
-	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
-	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-		std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
+		const std::vector<u64>& dataOffsets, const std::vector<u8>& updateFlags,
+		File::IOFile& file);
+	bool ReadMemoryUpdates(const FifoFileStruct::FileFrameInfo& srcFrame, const u8* payload,
+		std::vector<MemoryUpdate>& memUpdates) const;
+	std::shared_ptr<const std::vector<u8>> ReadChunk(u32 chunk) const;
+
+	std::shared_ptr<const FifoFrameInfo> ReadFrame(u32 frame) const;
+	bool ReadFileData(u64 offset, u64 size, u8* out) const;
 
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
@@ -97,5 +118,19 @@ private:
 	u32 m_Flags;
 	u32 m_Version;
 
-	std::vector<FifoFrameInfo> m_Frames;
+	// Frames added while recording
+	std::vector<std::shared_ptr<const FifoFrameInfo>> m_Frames;
+
+	// Frames of a loaded file, streamed from the mapping (or m_FileHandle if mapping failed)
+	std::vector<FifoFileStruct::FileFrameInfo> m_FrameIndex;
+	File::MappedFile m_MappedFile;
+	mutable File::IOFile m_FileHandle;
+	mutable std::vector<std::pair<u32, std::shared_ptr<const FifoFrameInfo>>> m_FrameCache;
+
+	// Memory update data shared between frames, decoded chunks stay alive while any frame uses them
+	std::vector<FifoFileStruct::FileMemoryChunk> m_Chunks;
+	mutable std::vector<std::weak_ptr<const std::vector<u8>>> m_ChunkData;
+
+	// GetFrame is called from both the CPU thread and the UI
+	mutable std::mutex m_FrameMutex;
 };
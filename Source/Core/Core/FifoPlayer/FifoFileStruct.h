@@ -11,8 +11,25 @@ namespace FifoFileStruct
 enum
 {
 	FILE_ID = 0x0d01f1f0,
-	VERSION_NUMBER = 4,
+	VERSION_NUMBER = 6,
 	MIN_LOADER_VERSION = 1,
+	// Files containing compressed frames can't be read by older loaders.
+	MIN_LOADER_VERSION_COMPRESSED = 5,
+	// Nor can files with memory updates referencing the shared chunk table.
+	MIN_LOADER_VERSION_CHUNKS = 6,
+};
+
+enum
+{
+	// Frame payload (FIFO data and memory update data) is stored as a single zlib stream.
+	// fifoDataOffset and FileMemoryUpdate::dataOffset are relative to the inflated payload.
+	FRAME_FLAG_COMPRESSED = 1,
+};
+
+enum
+{
+	// dataOffset is an index into the chunk table rather than a file or payload offset.
+	MEMORY_UPDATE_FLAG_CHUNK = 1,
 };
 
 #pragma pack(push, 4)
@@ -37,6 +54,9 @@ union FileHeader
 		u32 flags;
 		u64 texMemOffset;
 		u32 texMemSize;
+		// Version 6+, older writers left these uninitialized
+		u64 chunkTableOffset;
+		u32 chunkCount;
 	};
 	u32 rawData[32];
 };
@@ -51,6 +71,11 @@ union FileFrameInfo
 		u32 fifoEnd;
 		u64 memoryUpdatesOffset;
 		u32 numMemoryUpdates;
+		// Version 5+, older writers left these uninitialized
+		u32 frameFlags;
+		u64 payloadOffset;
+		u32 payloadCompressedSize;
+		u32 payloadSize;
 	};
 	u32 rawData[16];
 };
@@ -62,7 +87,22 @@ struct FileMemoryUpdate
 	u64 dataOffset;
 	u32 dataSize;
 	u8 type;
+	// Version 6+, older writers left this uninitialized
+	u8 flags;
+};
+
+// Memory update data shared by several frames. Identical blocks are only written once.
+struct FileMemoryChunk
+{
+	u64 dataOffset;
+	u32 dataSize;
+	// Zero if the chunk is stored uncompressed
+	u32 compressedSize;
 };
 
 #pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 128, "FileHeader must not change size");
+static_assert(sizeof(FileFrameInfo) == 64, "FileFrameInfo must not change size");
+static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate must not change size");
 }
@@ -0,0 +1,57 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/Hash.h"
+#include "Core/FifoPlayer/FifoMemoryStore.h"
+
+u64 FifoMemoryStore::HashData(const u8* data, u32 size)
+{
+	// Mix in the size so blocks that only differ in their zero padding don't collide
+	return GetHash64(data, size, 0) ^ size;
+}
+
+const FifoMemoryStore::Block* FifoMemoryStore::Find(u64 hash, const u8* data, u32 size) const
+{
+	auto range = m_blocks.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const std::vector<u8>& stored = *it->second;
+		if (stored.size() == size && (size == 0 || std::memcmp(stored.data(), data, size) == 0))
+			return &it->second;
+	}
+
+	return nullptr;
+}
+
+FifoMemoryStore::Block FifoMemoryStore::Intern(const u8* data, u32 size)
+{
+	const u64 hash = HashData(data, size);
+	if (const Block* existing = Find(hash, data, size))
+		return *existing;
+
+	Block block = std::make_shared<const std::vector<u8>>(data, data + size);
+	m_blocks.emplace(hash, block);
+	m_unique_bytes += size;
+	return block;
+}
+
+FifoMemoryStore::Block FifoMemoryStore::Intern(const Block& block)
+{
+	const u32 size = static_cast<u32>(block->size());
+	const u64 hash = HashData(block->data(), size);
+	if (const Block* existing = Find(hash, block->data(), size))
+		return *existing;
+
+	m_blocks.emplace(hash, block);
+	m_unique_bytes += size;
+	return block;
+}
+
+void FifoMemoryStore::Clear()
+{
+	m_blocks.clear();
+	m_unique_bytes = 0;
+}
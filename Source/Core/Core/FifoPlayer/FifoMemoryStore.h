@@ -0,0 +1,39 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Content addressed storage for memory update data.
+// Games often upload the same texture or vertex data over and over, so identical blocks are
+// kept once and shared by every MemoryUpdate that references them.
+class FifoMemoryStore
+{
+public:
+	using Block = std::shared_ptr<const std::vector<u8>>;
+
+	// Returns the stored block with the same contents, adding a copy of the data if it's new.
+	Block Intern(const u8* data, u32 size);
+
+	// Same as above, but stores block itself if no identical block exists yet.
+	Block Intern(const Block& block);
+
+	void Clear();
+
+	size_t GetBlockCount() const { return m_blocks.size(); }
+	u64 GetUniqueBytes() const { return m_unique_bytes; }
+
+private:
+	static u64 HashData(const u8* data, u32 size);
+	const Block* Find(u64 hash, const u8* data, u32 size) const;
+
+	std::unordered_multimap<u64, Block> m_blocks;
+	u64 m_unique_bytes = 0;
+};
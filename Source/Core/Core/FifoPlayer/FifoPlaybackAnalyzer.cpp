@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <memory>
+
 #include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
 
 #include "Common/CommonTypes.h"
@@ -38,13 +40,14 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
 
 	for (u32 frameIdx = 0; frameIdx < file->GetFrameCount(); ++frameIdx)
 	{
-		const FifoFrameInfo& frame = file->GetFrame(frameIdx);
+		// Frames are streamed from the file, only one needs to be in memory at a time
+		const std::shared_ptr<const FifoFrameInfo> framePtr = file->GetFrame(frameIdx);
+		const FifoFrameInfo& frame = *framePtr;
 		AnalyzedFrameInfo& analyzed = frameInfo[frameIdx];
 
 		s_DrawingObject = false;
 
 		u32 cmdStart = 0;
-		u32 nextMemUpdate = 0;
 
 #if LOG_FIFO_CMDS
 		// Debugging
@@ -53,14 +56,6 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
 
 		while (cmdStart < frame.fifoData.size())
 		{
-			// Add memory updates that have occurred before this point in the frame
-			while (nextMemUpdate < frame.memoryUpdates.size() &&
-				frame.memoryUpdates[nextMemUpdate].fifoPosition <= cmdStart)
-			{
-				analyzed.memoryUpdates.push_back(frame.memoryUpdates[nextMemUpdate]);
-				++nextMemUpdate;
-			}
-
 			bool wasDrawing = s_DrawingObject;
 
 			u32 cmdSize = FifoAnalyzer::AnalyzeCommand(&frame.fifoData[cmdStart], DECODE_PLAYBACK);
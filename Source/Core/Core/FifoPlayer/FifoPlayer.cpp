@@ -141,7 +141,11 @@ int FifoPlayer::AdvanceFrame()
 	if (m_EarlyMemoryUpdates && m_CurrentFrame == m_FrameRangeStart)
 		WriteAllMemoryUpdates();
 
-	WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
+	// Let the OS start paging in the next frame while this one is being played
+	if (m_CurrentFrame + 1 < m_FrameRangeEnd)
+		m_File->PrefetchFrame(m_CurrentFrame + 1);
+
+	WriteFrame(*m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
 
 	++m_CurrentFrame;
 	return CPU::CPU_RUNNING;
@@ -179,6 +183,10 @@ void FifoPlayer::SetFrameRangeStart(u32 start)
 
 		if (m_CurrentFrame < m_FrameRangeStart)
 			m_CurrentFrame = m_FrameRangeStart;
+
+		// Frames are read on demand, so jumping ahead doesn't touch the frames before start
+		if (start < frameCount)
+			m_File->PrefetchFrame(start);
 	}
 }
 
@@ -286,7 +294,7 @@ void FifoPlayer::WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate,
 
 	while (nextMemUpdate < frame.memoryUpdates.size() && dataStart < dataEnd)
 	{
-		const MemoryUpdate& memUpdate = info.memoryUpdates[nextMemUpdate];
+		const MemoryUpdate& memUpdate = frame.memoryUpdates[nextMemUpdate];
 
 		if (memUpdate.fifoPosition < dataEnd)
 		{
@@ -317,8 +325,8 @@ void FifoPlayer::WriteAllMemoryUpdates()
 
 	for (u32 frameNum = 0; frameNum < m_File->GetFrameCount(); ++frameNum)
 	{
-		const FifoFrameInfo& frame = m_File->GetFrame(frameNum);
-		for (auto& update : frame.memoryUpdates)
+		const std::shared_ptr<const FifoFrameInfo> frame = m_File->GetFrame(frameNum);
+		for (auto& update : frame->memoryUpdates)
 		{
 			WriteMemory(update);
 		}
@@ -334,7 +342,7 @@ void FifoPlayer::WriteMemory(const MemoryUpdate& memUpdate)
 	else
 		mem = &Memory::m_pRAM[memUpdate.address & Memory::RAM_MASK];
 
-	std::copy(memUpdate.data.begin(), memUpdate.data.end(), mem);
+	std::copy(memUpdate.data->begin(), memUpdate.data->end(), mem);
 }
 
 void FifoPlayer::WriteFifo(const u8* data, u32 start, u32 end)
@@ -373,7 +381,8 @@ void FifoPlayer::SetupFifo()
 	WriteCP(CommandProcessor::CTRL_REGISTER, 0);   // disable read, BP, interrupts
 	WriteCP(CommandProcessor::CLEAR_REGISTER, 7);  // clear overflow, underflow, metrics
 
-	const FifoFrameInfo& frame = m_File->GetFrame(m_CurrentFrame);
+	const std::shared_ptr<const FifoFrameInfo> framePtr = m_File->GetFrame(m_CurrentFrame);
+	const FifoFrameInfo& frame = *framePtr;
 
 	// Set fifo bounds
 	WriteCP(CommandProcessor::FIFO_BASE_LO, frame.fifoStart);
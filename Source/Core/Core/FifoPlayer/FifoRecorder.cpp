@@ -127,8 +127,7 @@ void FifoRecorder::UseMemory(u32 address, u32 size, MemoryUpdate::Type type, boo
 		memUpdate.address = address;
 		memUpdate.fifoPosition = (u32)(m_FifoData.size());
 		memUpdate.type = type;
-		memUpdate.data.resize(size);
-		std::copy(newData, newData + size, memUpdate.data.begin());
+		memUpdate.data = m_MemoryStore.Intern(newData, size);
 
 		m_CurrentFrame.memoryUpdates.push_back(std::move(memUpdate));
 	}
@@ -171,6 +170,9 @@ void FifoRecorder::EndFrame(u32 fifoStart, u32 fifoEnd)
 
 		m_FifoData.reserve(1024 * 1024 * 4);
 		m_FifoData.clear();
+
+		// Frames of the previous recording keep their data alive, only the lookup is reset
+		m_MemoryStore.Clear();
 	}
 
 	if (m_RequestedRecordingEnd)
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoMemoryStore.h"
 
 class FifoRecorder
 {
@@ -65,4 +66,6 @@ private:
 	std::vector<u8> m_FifoData;
 	std::vector<u8> m_Ram;
 	std::vector<u8> m_ExRam;
+	// Identical memory updates share their data
+	FifoMemoryStore m_MemoryStore;
 };
@@ -9,15 +9,32 @@
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 
 #define AX_GC
 #include "Core/HW/DSPHLE/UCodes/AXVoice.h"
 
+bool AXCapture::ReplayGCFrame(const VoiceFrame& frame, VoiceFrame* result)
+{
+	return ReplayCapturedVoice(frame, result);
+}
+
 AXUCode::AXUCode(DSPHLE* dsphle, u32 crc) : UCodeInterface(dsphle, crc), m_cmdlist_size(0)
 {
 	INFO_LOG(DSPHLE, "Instantiating AXUCode: crc=%08x", crc);
+
+	if (SConfig::GetInstance().m_DSPCaptureLog)
+	{
+		// The ucode is switched after boot, and on Wii between titles, so every instance gets its
+		// own file instead of truncating the capture of the one before.
+		static u32 s_capture_count = 0;
+		const std::string capture_path = File::GetUserPath(D_DUMPDSP_IDX) +
+			StringFromFormat("ax_voices_%08x_%u.axcap", crc, s_capture_count++);
+		m_voice_capture = std::make_unique<AXCapture::Recorder>(capture_path);
+	}
 }
 
 AXUCode::~AXUCode()
@@ -426,7 +443,7 @@ void AXUCode::ProcessPBList(u32 pb_addr)
 		{
 			ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
 
-			ProcessVoice(pb, buffers, spms, ConvertMixerControl(pb.mixer_control),
+			ProcessVoice(m_voice_capture.get(), pb, buffers, spms, ConvertMixerControl(pb.mixer_control),
 				m_coeffs_available ? m_coeffs : nullptr);
 
 			// Forward the buffers
@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <memory>
+
 #include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXCapture.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
 // We can't directly use the mixer_control field from the PB because it does
@@ -93,6 +96,9 @@ protected:
 	bool m_coeffs_available;
 	s16 m_coeffs[0x800];
 
+	// Records processed voices for offline replay, see AXCapture.h.
+	std::unique_ptr<AXCapture::Recorder> m_voice_capture;
+
 	void LoadResamplingCoefficients();
 
 	// Copy a command list from memory to our temp buffer
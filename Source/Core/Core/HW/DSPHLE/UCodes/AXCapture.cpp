@@ -0,0 +1,173 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <numeric>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/DSP.h"
+#include "Core/HW/DSPHLE/UCodes/AXCapture.h"
+
+namespace AXCapture
+{
+static const u32 CAPTURE_MAGIC = 0x50435841;  // "AXCP"
+static const u32 CAPTURE_VERSION = 2;
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+	u32 magic;
+	u32 version;
+};
+
+// Followed by the buffer sizes, pb_in, pb_out, the ARAM bytes and the mixed samples.
+struct FrameHeader
+{
+	u8 wii;
+	u8 rs_hack;
+	u16 sample_count;
+	u32 mixer_control;
+	u32 pb_size;
+	u32 aram_size;
+	u32 buffer_count;
+};
+#pragma pack(pop)
+
+ARAMSource* g_aram_source = nullptr;
+
+Recorder::Recorder(const std::string& filename) : m_file(filename, "wb"), m_buffers(nullptr)
+{
+	FileHeader header = { CAPTURE_MAGIC, CAPTURE_VERSION };
+	if (!m_file.WriteArray(&header, 1))
+		ERROR_LOG(DSPHLE, "Could not create AX voice capture %s", filename.c_str());
+}
+
+void Recorder::BeginVoice(bool wii, const void* pb, size_t pb_size, int* const* buffers,
+	const u32* buffer_sizes, u32 buffer_count, u16 sample_count, u32 mixer_control)
+{
+	m_frame.wii = wii;
+	m_frame.rs_hack = SConfig::GetInstance().bRSHACK;
+	m_frame.sample_count = sample_count;
+	m_frame.mixer_control = mixer_control;
+	m_frame.pb_in.assign(static_cast<const u8*>(pb), static_cast<const u8*>(pb) + pb_size);
+	m_frame.aram.clear();
+	m_frame.buffer_sizes.assign(buffer_sizes, buffer_sizes + buffer_count);
+
+	// The output buffers already hold the voices mixed before this one, keep
+	// them around so only this voice's contribution ends up in the capture.
+	m_buffers = buffers;
+	m_buffers_before.clear();
+	for (u32 i = 0; i < buffer_count; ++i)
+		m_buffers_before.insert(m_buffers_before.end(), buffers[i], buffers[i] + buffer_sizes[i]);
+
+	g_aram_source = this;
+}
+
+void Recorder::EndVoice(const void* pb)
+{
+	g_aram_source = nullptr;
+
+	const u8* pb_bytes = static_cast<const u8*>(pb);
+	m_frame.pb_out.assign(pb_bytes, pb_bytes + m_frame.pb_in.size());
+
+	m_frame.mix.resize(m_buffers_before.size());
+	size_t pos = 0;
+	for (u32 i = 0; i < m_frame.buffer_sizes.size(); ++i)
+	{
+		for (u32 j = 0; j < m_frame.buffer_sizes[i]; ++j, ++pos)
+			m_frame.mix[pos] = m_buffers[i][j] - m_buffers_before[pos];
+	}
+
+	WriteFrame(m_file, m_frame);
+}
+
+u8 Recorder::Read(u32 address)
+{
+	u8 value = DSP::ReadARAM(address);
+	m_frame.aram.push_back(value);
+	return value;
+}
+
+bool WriteFrame(File::IOFile& file, const VoiceFrame& frame)
+{
+	FrameHeader header;
+	header.wii = frame.wii;
+	header.rs_hack = frame.rs_hack;
+	header.sample_count = frame.sample_count;
+	header.mixer_control = frame.mixer_control;
+	header.pb_size = static_cast<u32>(frame.pb_in.size());
+	header.aram_size = static_cast<u32>(frame.aram.size());
+	header.buffer_count = static_cast<u32>(frame.buffer_sizes.size());
+
+	return file.WriteArray(&header, 1) &&
+		file.WriteArray(frame.buffer_sizes.data(), frame.buffer_sizes.size()) &&
+		file.WriteBytes(frame.pb_in.data(), frame.pb_in.size()) &&
+		file.WriteBytes(frame.pb_out.data(), frame.pb_out.size()) &&
+		file.WriteBytes(frame.aram.data(), frame.aram.size()) &&
+		file.WriteArray(frame.mix.data(), frame.mix.size());
+}
+
+bool ReadFrame(File::IOFile& file, VoiceFrame* frame)
+{
+	FrameHeader header;
+	if (!file.ReadArray(&header, 1))
+		return false;
+
+	frame->wii = header.wii != 0;
+	frame->rs_hack = header.rs_hack != 0;
+	frame->sample_count = header.sample_count;
+	frame->mixer_control = header.mixer_control;
+	frame->pb_in.resize(header.pb_size);
+	frame->pb_out.resize(header.pb_size);
+	frame->aram.resize(header.aram_size);
+	frame->buffer_sizes.resize(header.buffer_count);
+	if (!file.ReadArray(frame->buffer_sizes.data(), frame->buffer_sizes.size()))
+		return false;
+	frame->mix.resize(
+		std::accumulate(frame->buffer_sizes.begin(), frame->buffer_sizes.end(), size_t(0)));
+
+	return file.ReadBytes(frame->pb_in.data(), frame->pb_in.size()) &&
+		file.ReadBytes(frame->pb_out.data(), frame->pb_out.size()) &&
+		file.ReadBytes(frame->aram.data(), frame->aram.size()) &&
+		file.ReadArray(frame->mix.data(), frame->mix.size());
+}
+
+bool LoadCapture(const std::string& filename, std::vector<VoiceFrame>* frames)
+{
+	File::IOFile file(filename, "rb");
+	FileHeader header;
+	if (!file.ReadArray(&header, 1) || header.magic != CAPTURE_MAGIC ||
+		header.version != CAPTURE_VERSION)
+	{
+		ERROR_LOG(DSPHLE, "%s is not an AX voice capture", filename.c_str());
+		return false;
+	}
+
+	VoiceFrame frame;
+	while (ReadFrame(file, &frame))
+		frames->push_back(frame);
+	return true;
+}
+
+bool ReplayFrame(const VoiceFrame& frame, VoiceFrame* result)
+{
+	bool& rs_hack = SConfig::GetInstance().bRSHACK;
+	const bool old_rs_hack = rs_hack;
+	rs_hack = frame.rs_hack;
+
+	bool success = frame.wii ? ReplayWiiFrame(frame, result) : ReplayGCFrame(frame, result);
+
+	rs_hack = old_rs_hack;
+	return success;
+}
+
+bool FramesMatch(const VoiceFrame& expected, const VoiceFrame& actual)
+{
+	return expected.pb_out == actual.pb_out && expected.aram == actual.aram &&
+		expected.mix == actual.mix;
+}
+}
@@ -0,0 +1,86 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Capture and offline replay of AX HLE voice processing.
+//
+// When the DSP capture log is enabled, the AX ucodes record every running voice they
+// process: the parameter block going in, every ARAM byte the accelerator reads, and
+// the parameter block and mixed samples coming out. Replaying a frame runs the very
+// same voice code without any emulated hardware, so a capture doubles as a golden file
+// for regression tests and as a benchmark input.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/NonCopyable.h"
+
+namespace AXCapture
+{
+// One voice processed for one AX frame (1ms on GC, 1ms or 3ms on Wii).
+struct VoiceFrame
+{
+	bool wii = false;
+	bool rs_hack = false;
+	u16 sample_count = 0;
+	u32 mixer_control = 0;  // Already converted to AXMixControl.
+	std::vector<u8> pb_in;
+	std::vector<u8> pb_out;
+	// ARAM bytes in the order the accelerator read them.
+	std::vector<u8> aram;
+	// Samples in each output buffer, in the order of AXBuffers. The Wiimote buffers
+	// are shorter than sample_count.
+	std::vector<u32> buffer_sizes;
+	// What the voice added to each output buffer, one buffer after the other.
+	std::vector<s32> mix;
+};
+
+// Accelerator ARAM reads go through this while a voice is being captured or replayed.
+class ARAMSource
+{
+public:
+	virtual ~ARAMSource() {}
+	virtual u8 Read(u32 address) = 0;
+};
+
+extern ARAMSource* g_aram_source;
+
+class Recorder final : public ARAMSource, NonCopyable
+{
+public:
+	explicit Recorder(const std::string& filename);
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	void BeginVoice(bool wii, const void* pb, size_t pb_size, int* const* buffers,
+		const u32* buffer_sizes, u32 buffer_count, u16 sample_count, u32 mixer_control);
+	void EndVoice(const void* pb);
+
+	u8 Read(u32 address) override;
+
+private:
+	File::IOFile m_file;
+	VoiceFrame m_frame;
+	int* const* m_buffers;
+	std::vector<s32> m_buffers_before;
+};
+
+bool WriteFrame(File::IOFile& file, const VoiceFrame& frame);
+bool ReadFrame(File::IOFile& file, VoiceFrame* frame);
+bool LoadCapture(const std::string& filename, std::vector<VoiceFrame>* frames);
+
+// Runs frame.pb_in through the voice code, feeding it the captured ARAM bytes, and
+// stores what it produced in result. Returns false if the frame is malformed.
+bool ReplayFrame(const VoiceFrame& frame, VoiceFrame* result);
+
+// Compares the output of a replay against the captured frame.
+bool FramesMatch(const VoiceFrame& expected, const VoiceFrame& actual);
+
+// Implemented next to the GC and Wii voice code, which only exists in AX.cpp and AXWii.cpp.
+bool ReplayGCFrame(const VoiceFrame& frame, VoiceFrame* result);
+bool ReplayWiiFrame(const VoiceFrame& frame, VoiceFrame* result);
+}
@@ -12,13 +12,19 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
+#include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
+#include "Core/HW/DSPHLE/UCodes/AXCapture.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/Memmap.h"
 
@@ -30,6 +36,21 @@
 #define MAX_SAMPLES_PER_FRAME 96
 #endif
 
+// The SSE4.1 kernels are only called when the CPU has it. GCC and Clang only emit it in
+// functions marked for it, as builds target SSE2 or Core 2.
+#ifdef _M_X86
+#ifdef _MSC_VER
+#define AX_SSE41
+#else
+#define AX_SSE41 __attribute__((target("sse4.1")))
+#endif
+#endif
+
+// Input samples decoded ahead of resampling for one frame. The valid ratio range
+// tops out at 4.0, so this leaves room for games that go a bit over it; voices
+// with even larger ratios are read from the accelerator sample by sample.
+#define MAX_INPUT_SAMPLES_PER_FRAME (MAX_SAMPLES_PER_FRAME * 8)
+
 // Put all of that in an anonymous namespace to avoid stupid compilers merging
 // functions from AX GC and AX Wii.
 namespace
@@ -76,6 +97,26 @@ union AXBuffers {
 #endif
 };
 
+#ifdef AX_WII
+// Samples mixed into the Wiimote buffers for <count> samples of the other buffers.
+// Old AXWii versions process ms per ms.
+u16 WiimoteSampleCount(u16 count)
+{
+	return count == 96 ? 18 : 6;
+}
+#endif
+
+// Samples mixed into AXBuffers::ptrs[buffer] for <count> samples of the main output.
+u32 BufferSampleCount(u32 buffer, u16 count)
+{
+#ifdef AX_WII
+	// The Wiimote buffers come after the 12 main and AUX buffers.
+	if (buffer >= 12)
+		return WiimoteSampleCount(count);
+#endif
+	return count;
+}
+
 // Read a PB from MRAM/ARAM
 void ReadPB(u32 addr, PB_TYPE& pb)
 {
@@ -90,7 +131,6 @@ void WritePB(u32 addr, const PB_TYPE& pb)
 	Memory::CopyToEmuSwapped<u16>(addr, src, sizeof(pb));
 }
 
-#if 0
 // Dump the value of a PB for debugging
 #define DUMP_U16(field) WARN_LOG(DSPHLE, "    %04x (%s)", pb.field, #field)
 #define DUMP_U32(field) WARN_LOG(DSPHLE, "    %08x (%s)", HILO_TO_32(pb.field), #field)
@@ -107,10 +147,17 @@ void DumpPB(const PB_TYPE& pb)
 #endif
 	DUMP_U16(running);
 	DUMP_U16(is_stream);
+	DUMP_U16(vol_env.cur_volume);
+	DUMP_U16(audio_addr.sample_format);
+	DUMP_U32(audio_addr.cur_addr);
+	DUMP_U32(audio_addr.end_addr);
+	DUMP_U32(src.ratio);
+	DUMP_U16(src.cur_addr_frac);
 
 	// TODO: complete as needed
 }
-#endif
+#undef DUMP_U16
+#undef DUMP_U32
 
 // Simulated accelerator state.
 static u32 acc_loop_addr, acc_end_addr;
@@ -128,6 +175,14 @@ void AcceleratorSetup(PB_TYPE* pb, u32* cur_addr)
 	acc_end_reached = false;
 }
 
+// Reads a byte of ARAM, through the AX capture when one is recording or replaying.
+u8 AcceleratorReadARAM(u32 address)
+{
+	if (AXCapture::g_aram_source)
+		return AXCapture::g_aram_source->Read(address);
+	return DSP::ReadARAM(address);
+}
+
 // Reads a sample from the simulated accelerator. Also handles looping and
 // disabling streams that reached the end (this is done by an exception raised
 // by the accelerator on real hardware).
@@ -147,7 +202,7 @@ u16 AcceleratorGetSample()
 		// ADPCM decoding, not much to explain here.
 		if ((*acc_cur_addr & 15) == 0)
 		{
-			acc_pb->adpcm.pred_scale = DSP::ReadARAM((*acc_cur_addr & ~15) >> 1);
+			acc_pb->adpcm.pred_scale = AcceleratorReadARAM((*acc_cur_addr & ~15) >> 1);
 			*acc_cur_addr += 2;
 		}
 
@@ -170,8 +225,8 @@ u16 AcceleratorGetSample()
 		s32 coef1 = acc_pb->adpcm.coefs[coef_idx * 2 + 0];
 		s32 coef2 = acc_pb->adpcm.coefs[coef_idx * 2 + 1];
 
-		int temp = (*acc_cur_addr & 1) ? (DSP::ReadARAM(*acc_cur_addr >> 1) & 0xF) :
-			(DSP::ReadARAM(*acc_cur_addr >> 1) >> 4);
+		int temp = (*acc_cur_addr & 1) ? (AcceleratorReadARAM(*acc_cur_addr >> 1) & 0xF) :
+			(AcceleratorReadARAM(*acc_cur_addr >> 1) >> 4);
 
 		if (temp >= 8)
 			temp -= 16;
@@ -188,15 +243,20 @@ u16 AcceleratorGetSample()
 	}
 
 	case 0x0A:  // 16-bit PCM audio
-		ret = (DSP::ReadARAM(*acc_cur_addr * 2) << 8) | DSP::ReadARAM(*acc_cur_addr * 2 + 1);
+	{
+		// Keep the two reads in order, captures depend on it.
+		u16 hi = AcceleratorReadARAM(*acc_cur_addr * 2);
+		u16 lo = AcceleratorReadARAM(*acc_cur_addr * 2 + 1);
+		ret = (hi << 8) | lo;
 		acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
 		acc_pb->adpcm.yn1 = ret;
 		step_size_bytes = 2;
 		*acc_cur_addr += 1;
 		break;
+	}
 
 	case 0x19:  // 8-bit PCM audio
-		ret = DSP::ReadARAM(*acc_cur_addr) << 8;
+		ret = AcceleratorReadARAM(*acc_cur_addr) << 8;
 		acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
 		acc_pb->adpcm.yn1 = ret;
 		step_size_bytes = 2;
@@ -268,6 +328,13 @@ u16 AcceleratorGetSample()
 	return ret;
 }
 
+// Reads <count> consecutive samples from the simulated accelerator.
+void AcceleratorGetSamples(s16* output, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+		output[i] = AcceleratorGetSample();
+}
+
 // Reads samples from the input callback, resamples them to <count> samples at
 // the wanted sample rate (computed from the ratio, see below).
 //
@@ -288,7 +355,8 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count, s16* last_samples,
 	u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
 {
 	int read_samples_count = 0;
@@ -403,6 +471,50 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 	return curr_pos;
 }
 
+// Number of input samples ResampleAudio will consume to produce <count> samples.
+u64 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+		return (curr_pos + (u64)count * ratio) >> 16;
+	return count;
+}
+
+// Same as ResampleAudio, but for input that has already been read in full.
+// <history> holds the four last_samples followed by every input sample the
+// call consumes, which lets each output sample be computed straight from its
+// position instead of stepping through the input one sample at a time.
+u32 ResampleAudioBlock(const s16* history, s16* output, u32 count, s16* last_samples, u32 curr_pos,
+	u32 ratio, int srctype)
+{
+	u32 consumed;
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 pos = curr_pos + (i + 1) * ratio;
+			u32 idx = pos >> 16;
+			s32 curr_frac = pos & 0xFFFF;
+
+			// A zero fraction gives back history[idx] unchanged.
+			s32 s0 = history[idx];
+			s32 s1 = history[idx + 1];
+			output[i] = (s16)((s0 * (0x10000 - curr_frac) + s1 * curr_frac) >> 16);
+		}
+
+		u32 end_pos = curr_pos + count * ratio;
+		consumed = end_pos >> 16;
+		curr_pos = end_pos & 0xFFFF;
+	}
+	else  // SRCTYPE_NEAREST
+	{
+		memcpy(output, history + 4, count * sizeof(s16));
+		consumed = count;
+	}
+
+	memcpy(last_samples, history + consumed, 4 * sizeof(s16));
+	return curr_pos;
+}
+
 // Read <count> input samples from ARAM, decoding and converting rate
 // if required.
 void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
@@ -412,9 +524,24 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 
 	if (coeffs)
 		coeffs += pb.coef_select * 0x200;
-	u32 curr_pos =
-		ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
-			pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
+
+	u32 ratio = HILO_TO_32(pb.src.ratio);
+	u64 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+	u32 curr_pos;
+	if (input_count <= MAX_INPUT_SAMPLES_PER_FRAME)
+	{
+		// Decode the whole frame first so the resampler works on plain memory.
+		s16 history[4 + MAX_INPUT_SAMPLES_PER_FRAME];
+		memcpy(history, pb.src.last_samples, sizeof(pb.src.last_samples));
+		AcceleratorGetSamples(history + 4, (u32)input_count);
+		curr_pos = ResampleAudioBlock(history, samples, count, pb.src.last_samples,
+			pb.src.cur_addr_frac, ratio, pb.src_type);
+	}
+	else
+	{
+		curr_pos = ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count,
+			pb.src.last_samples, pb.src.cur_addr_frac, ratio, pb.src_type, coeffs);
+	}
 	pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
 	// Update current position in the PB.
@@ -422,6 +549,79 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
+#ifdef _M_X86
+// Volumes for the next four samples, wrapping around like the u16 the DSP keeps them in.
+AX_SSE41 __m128i VolumeRamp4(u16 volume, u16 volume_delta)
+{
+	return _mm_and_si128(_mm_setr_epi32(volume, volume + volume_delta, volume + 2 * volume_delta,
+		volume + 3 * volume_delta), _mm_set1_epi32(0xFFFF));
+}
+
+// (sample * volume) >> 15 for four samples, clamped to [-32767, 32767].
+// The product of a s16 sample and a u16 volume always fits in 32 bits.
+AX_SSE41 __m128i ApplyVolume4(__m128i samples, __m128i volumes)
+{
+	__m128i result = _mm_srai_epi32(_mm_mullo_epi32(samples, volumes), 15);
+	return _mm_max_epi32(_mm_min_epi32(result, _mm_set1_epi32(32767)), _mm_set1_epi32(-32767));
+}
+
+// ApplyVolumeEnvelope four samples at a time. Returns how many samples were done.
+AX_SSE41 u32 ApplyVolumeEnvelopeSSE41(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+	const __m128i mask = _mm_set1_epi32(0xFFFF);
+	const __m128i step = _mm_set1_epi32((u16)(volume_delta * 4));
+	__m128i volumes = VolumeRamp4(volume, volume_delta);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i input = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)&samples[i]));
+		__m128i result = ApplyVolume4(input, volumes);
+		_mm_storel_epi64((__m128i*)&samples[i], _mm_packs_epi32(result, result));
+		volumes = _mm_and_si128(_mm_add_epi32(volumes, step), mask);
+	}
+	volume += (u16)(volume_delta * i);
+	return i;
+}
+
+// MixAdd four samples at a time, for at least four samples. Returns how many were done.
+AX_SSE41 u32 MixAddSSE41(int* out, const s16* input, u32 count, u16& volume, u16 volume_delta,
+	s16* dpop)
+{
+	const __m128i mask = _mm_set1_epi32(0xFFFF);
+	const __m128i step = _mm_set1_epi32((u16)(volume_delta * 4));
+	__m128i volumes = VolumeRamp4(volume, volume_delta);
+	__m128i sample = _mm_setzero_si128();
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i input_samples = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)&input[i]));
+		sample = ApplyVolume4(input_samples, volumes);
+		__m128i* dst = (__m128i*)&out[i];
+		_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), sample));
+		volumes = _mm_and_si128(_mm_add_epi32(volumes, step), mask);
+	}
+	volume += (u16)(volume_delta * i);
+	*dpop = (s16)_mm_extract_epi32(sample, 3);
+	return i;
+}
+#endif
+
+// Apply a volume ramp in place, moving the volume by <volume_delta> after each sample.
+void ApplyVolumeEnvelope(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+	u32 i = 0;
+#ifdef _M_X86
+	if (cpu_info.bSSE4_1)
+		i = ApplyVolumeEnvelopeSSE41(samples, count, volume, volume_delta);
+#endif
+	for (; i < count; ++i)
+	{
+		samples[i] = MathUtil::Clamp(((s32)samples[i] * volume) >> 15, -32767,
+			32767);  // -32768 ?
+		volume += volume_delta;
+	}
+}
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
@@ -434,7 +634,12 @@ void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ra
 	if (!ramp)
 		volume_delta = 0;
 
-	for (u32 i = 0; i < count; ++i)
+	u32 i = 0;
+#ifdef _M_X86
+	if (count >= 4 && cpu_info.bSSE4_1)
+		i = MixAddSSE41(out, input, count, volume, volume_delta, dpop);
+#endif
+	for (; i < count; ++i)
 	{
 		s64 sample = input[i];
 		sample *= volume;
@@ -471,12 +676,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = MathUtil::Clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-			32767);  // -32768 ?
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	ApplyVolumeEnvelope(samples, count, pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -544,17 +744,18 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	// Wiimote mixing.
 	if (pb.remote)
 	{
-		// Old AXWii versions process ms per ms.
-		u16 wm_count = count == 96 ? 18 : 6;
+		u16 wm_count = WiimoteSampleCount(count);
 
 		// Interpolate at most 18 samples from the 96 samples we read before.
 		s16 wm_samples[18];
 
 		// We use ratio 0x55555 == (5 * 65536 + 21845) / 65536 == 5.3333 which
 		// is the nearest we can get to 96/18
-		u32 curr_pos = ResampleAudio([&samples](u32 i) { return samples[i]; }, wm_samples, wm_count,
-			pb.remote_src.last_samples, pb.remote_src.cur_addr_frac, 0x55555,
-			SRCTYPE_POLYPHASE, coeffs);
+		s16 wm_history[4 + MAX_SAMPLES_PER_FRAME];
+		memcpy(wm_history, pb.remote_src.last_samples, sizeof(pb.remote_src.last_samples));
+		memcpy(wm_history + 4, samples, count * sizeof(s16));
+		u32 curr_pos = ResampleAudioBlock(wm_history, wm_samples, wm_count, pb.remote_src.last_samples,
+			pb.remote_src.cur_addr_frac, 0x55555, SRCTYPE_POLYPHASE);
 		pb.remote_src.cur_addr_frac = curr_pos & 0xFFFF;
 
 		// Mix to main[0-3] and aux[0-3]
@@ -591,4 +792,89 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 #endif
 }
 
+// ProcessVoice, recording the voice to <capture> when a capture is running.
+void ProcessVoice(AXCapture::Recorder* capture, PB_TYPE& pb, const AXBuffers& buffers, u16 count,
+	AXMixControl mctrl, const s16* coeffs)
+{
+	if (!capture || !pb.running)
+	{
+		ProcessVoice(pb, buffers, count, mctrl, coeffs);
+		return;
+	}
+
+#ifdef AX_GC
+	const bool wii = false;
+#else
+	const bool wii = true;
+#endif
+	u32 sizes[sizeof(AXBuffers::ptrs) / sizeof(AXBuffers::ptrs[0])];
+	for (u32 i = 0; i < ArraySize(sizes); ++i)
+		sizes[i] = BufferSampleCount(i, count);
+	capture->BeginVoice(wii, &pb, sizeof(pb), buffers.ptrs, sizes, ArraySize(sizes), count, mctrl);
+	ProcessVoice(pb, buffers, count, mctrl, coeffs);
+	capture->EndVoice(&pb);
+}
+
+// Feeds the ARAM bytes of a capture back to the accelerator. A replay that
+// diverges from the capture may want more bytes than were recorded; it gets
+// zeroes, and the extra reads show up as an ARAM mismatch.
+class ARAMReplay final : public AXCapture::ARAMSource
+{
+public:
+	ARAMReplay(const std::vector<u8>& data, std::vector<u8>* consumed) : m_data(data), m_consumed(consumed) {}
+	u8 Read(u32 address) override
+	{
+		size_t pos = m_consumed->size();
+		u8 value = pos < m_data.size() ? m_data[pos] : 0;
+		m_consumed->push_back(value);
+		return value;
+	}
+
+private:
+	const std::vector<u8>& m_data;
+	std::vector<u8>* m_consumed;
+};
+
+bool ReplayCapturedVoice(const AXCapture::VoiceFrame& frame, AXCapture::VoiceFrame* result)
+{
+	PB_TYPE pb;
+	AXBuffers buffers;
+	if (frame.pb_in.size() != sizeof(pb) || frame.buffer_sizes.size() != ArraySize(buffers.ptrs) ||
+		frame.sample_count > MAX_SAMPLES_PER_FRAME)
+	{
+		return false;
+	}
+	for (u32 i = 0; i < ArraySize(buffers.ptrs); ++i)
+	{
+		if (frame.buffer_sizes[i] != BufferSampleCount(i, frame.sample_count))
+			return false;
+	}
+
+	*result = frame;
+	result->aram.clear();
+	std::fill(result->mix.begin(), result->mix.end(), 0);
+	size_t pos = 0;
+	for (u32 i = 0; i < ArraySize(buffers.ptrs); ++i)
+	{
+		buffers.ptrs[i] = &result->mix[pos];
+		pos += frame.buffer_sizes[i];
+	}
+
+	memcpy(&pb, frame.pb_in.data(), sizeof(pb));
+	ARAMReplay replay(frame.aram, &result->aram);
+	AXCapture::g_aram_source = &replay;
+	// The polyphase resampler is disabled, so the DROM coefficients never change the output.
+	ProcessVoice(pb, buffers, frame.sample_count, static_cast<AXMixControl>(frame.mixer_control),
+		nullptr);
+	AXCapture::g_aram_source = nullptr;
+
+	result->pb_out.assign(reinterpret_cast<const u8*>(&pb), reinterpret_cast<const u8*>(&pb) + sizeof(pb));
+	if (result->pb_out != frame.pb_out)
+	{
+		WARN_LOG(DSPHLE, "Replayed AX voice does not match its capture, PB after replay:");
+		DumpPB(pb);
+	}
+	return true;
+}
+
 }  // namespace
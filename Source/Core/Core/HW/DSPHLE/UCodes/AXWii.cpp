@@ -15,6 +15,11 @@
 #include "Core/HW/DSPHLE/UCodes/AXVoice.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
+bool AXCapture::ReplayWiiFrame(const VoiceFrame& frame, VoiceFrame* result)
+{
+	return ReplayCapturedVoice(frame, result);
+}
+
 AXWiiUCode::AXWiiUCode(DSPHLE* dsphle, u32 crc) : AXUCode(dsphle, crc), m_last_main_volume(0x8000)
 {
 	for (u16& volume : m_last_aux_volumes)
@@ -460,8 +465,8 @@ void AXWiiUCode::ProcessPBList(u32 pb_addr)
 			for (int curr_ms = 0; curr_ms < 3; ++curr_ms)
 			{
 				ApplyUpdatesForMs(curr_ms, (u16*)&pb, num_updates, updates);
-				ProcessVoice(pb, buffers, 32, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
-					m_coeffs_available ? m_coeffs : nullptr);
+				ProcessVoice(m_voice_capture.get(), pb, buffers, 32,
+					ConvertMixerControl(HILO_TO_32(pb.mixer_control)), m_coeffs_available ? m_coeffs : nullptr);
 
 				// Forward the buffers
 				for (size_t i = 0; i < ArraySize(buffers.ptrs); ++i)
@@ -471,8 +476,8 @@ void AXWiiUCode::ProcessPBList(u32 pb_addr)
 		}
 		else
 		{
-			ProcessVoice(pb, buffers, 96, ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
-				m_coeffs_available ? m_coeffs : nullptr);
+			ProcessVoice(m_voice_capture.get(), pb, buffers, 96,
+				ConvertMixerControl(HILO_TO_32(pb.mixer_control)), m_coeffs_available ? m_coeffs : nullptr);
 		}
 
 		WritePB(pb_addr, pb);
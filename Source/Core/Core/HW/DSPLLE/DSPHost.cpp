@@ -118,7 +118,7 @@ void CodeLoaded(const u8* ptr, int size)
 	UpdateDebugger();
 
 	if (g_dsp_jit)
-		g_dsp_jit->ClearIRAM();
+		g_dsp_jit->SwitchUCode();
 
 	DSPAnalyzer::Analyze();
 }
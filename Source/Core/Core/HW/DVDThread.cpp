@@ -2,8 +2,11 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <utility>
@@ -26,6 +29,8 @@
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 
+#include "DiscIO/Enums.h"
+#include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
 
 namespace DVDThread
@@ -79,6 +84,40 @@ static Common::FifoQueue<ReadRequest, false> s_request_queue;
 static Common::FifoQueue<ReadResult, false> s_result_queue;
 static std::map<u64, ReadResult> s_result_map;
 
+// Buffers of finished requests, handed back by the CPU thread for the DVD thread to reuse.
+static const u32 MAX_POOLED_BUFFERS = 16;
+static Common::FifoQueue<std::vector<u8>> s_buffer_pool;
+
+// Requests that continue each other on the disc are read with a single IVolume::Read.
+static const u64 MAX_COALESCED_LENGTH = 4 * 1024 * 1024;
+
+// When the request queue runs dry after a sequential read inside a file, the DVD thread
+// reads up to READ_AHEAD_WINDOW bytes ahead, without going past the end of the file.
+// This happens in small chunks so that a new request never waits long behind it.
+static const u64 READ_AHEAD_WINDOW = 1024 * 1024;
+static const u32 READ_AHEAD_CHUNK = 128 * 1024;
+
+// The rest is only used by the DVD thread. It is restarted before the volume changes,
+// so none of this ever refers to another volume.
+struct FileExtent
+{
+	u64 start;
+	u64 end;
+};
+
+static std::vector<FileExtent> s_file_extents;  // Sorted by start.
+static bool s_file_extents_loaded;
+static bool s_file_extents_decrypted;
+
+static std::vector<u8> s_read_ahead;
+static u64 s_read_ahead_offset;
+static bool s_read_ahead_decrypt;
+
+static std::vector<u8> s_coalesce_buffer;
+static u64 s_last_read_end;
+static bool s_last_read_decrypt;
+static bool s_last_read_sequential;
+
 void Start()
 {
 	s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -87,6 +126,7 @@ void Start()
 	s_result_queue_expanded.Reset();
 	s_request_queue.Clear();
 	s_result_queue.Clear();
+	s_buffer_pool.Clear();
 
 	// This is reset on every launch for determinism, but it doesn't matter
 	// much, because this will never get exposed to the emulated game.
@@ -105,6 +145,9 @@ static void StartDVDThread()
 void Stop()
 {
 	StopDVDThread();
+	s_buffer_pool.Clear();
+	std::vector<u8>().swap(s_read_ahead);
+	std::vector<u8>().swap(s_coalesce_buffer);
 }
 
 static void StopDVDThread()
@@ -261,12 +304,186 @@ static void FinishRead(u64 id, s64 cycles_late)
 	// Notify the emulated software that the command has been executed
 	DVDInterface::FinishExecutingCommand(request.reply_type, DVDInterface::INT_TCINT, cycles_late,
 		buffer);
+
+	if (s_buffer_pool.Size() < MAX_POOLED_BUFFERS)
+		s_buffer_pool.Push(std::move(result.second));
+}
+
+static void LoadFileExtents()
+{
+	s_file_extents_loaded = true;
+
+	const DiscIO::IVolume& volume = DVDInterface::GetVolume();
+	// File offsets in the FST of a Wii disc are offsets in its decrypted partition.
+	s_file_extents_decrypted = volume.GetVolumeType() == DiscIO::Platform::WII_DISC;
+
+	std::unique_ptr<DiscIO::IFileSystem> filesystem = DiscIO::CreateFileSystem(&volume);
+	if (!filesystem || !filesystem->IsValid())
+		return;
+
+	for (const DiscIO::SFileInfo& info : filesystem->GetFileList())
+	{
+		if (!info.IsDirectory() && info.m_FileSize != 0)
+			s_file_extents.push_back({info.m_Offset, info.m_Offset + info.m_FileSize});
+	}
+	std::sort(s_file_extents.begin(), s_file_extents.end(),
+		[](const FileExtent& a, const FileExtent& b) { return a.start < b.start; });
+}
+
+// Returns the end of the file containing offset, or 0 if it isn't part of any file.
+static u64 GetFileEnd(u64 offset, bool decrypt)
+{
+	if (!s_file_extents_loaded)
+		LoadFileExtents();
+	if (decrypt != s_file_extents_decrypted)
+		return 0;
+
+	auto it = std::upper_bound(s_file_extents.begin(), s_file_extents.end(), offset,
+		[](u64 value, const FileExtent& extent) { return value < extent.start; });
+	if (it == s_file_extents.begin())
+		return 0;
+	--it;
+	return offset < it->end ? it->end : 0;
+}
+
+static std::vector<u8> GetBuffer(u32 length)
+{
+	std::vector<u8> buffer;
+	s_buffer_pool.Pop(buffer);
+	buffer.resize(length);
+	return buffer;
+}
+
+static bool ReadFromDisc(u64 offset, u64 length, u8* out, bool decrypt)
+{
+	s_last_read_sequential = offset == s_last_read_end && decrypt == s_last_read_decrypt;
+	s_last_read_end = offset + length;
+	s_last_read_decrypt = decrypt;
+
+	const u64 read_ahead_end = s_read_ahead_offset + s_read_ahead.size();
+	if (decrypt == s_read_ahead_decrypt && offset >= s_read_ahead_offset && offset < read_ahead_end)
+	{
+		const u64 count = std::min(length, read_ahead_end - offset);
+		memcpy(out, &s_read_ahead[offset - s_read_ahead_offset], count);
+		// Keep streaming as long as the game keeps reading what we prefetched.
+		s_last_read_sequential = true;
+		offset += count;
+		out += count;
+		length -= count;
+	}
+
+	return length == 0 || DVDInterface::GetVolume().Read(offset, length, out, decrypt);
+}
+
+static void PushResult(ReadRequest&& request, std::vector<u8>&& buffer)
+{
+	request.realtime_done_us = Common::Timer::GetTimeUs();
+	s_result_queue.Push(ReadResult(std::move(request), std::move(buffer)));
+	s_result_queue_expanded.Set();
+}
+
+static void ProcessRequests(std::vector<ReadRequest>* requests)
+{
+	size_t i = 0;
+	while (i < requests->size())
+	{
+		// Find the requests that directly follow this one on the disc.
+		const ReadRequest& first = (*requests)[i];
+		u64 end = first.dvd_offset + first.length;
+		size_t count = 1;
+		while (i + count < requests->size())
+		{
+			const ReadRequest& next = (*requests)[i + count];
+			if (next.decrypt != first.decrypt || next.dvd_offset != end ||
+				end + next.length - first.dvd_offset > MAX_COALESCED_LENGTH)
+			{
+				break;
+			}
+			end += next.length;
+			++count;
+		}
+
+		if (count == 1)
+		{
+			ReadRequest& request = (*requests)[i];
+			std::vector<u8> buffer = GetBuffer(request.length);
+			if (!ReadFromDisc(request.dvd_offset, request.length, buffer.data(), request.decrypt))
+				buffer.clear();
+			PushResult(std::move(request), std::move(buffer));
+		}
+		else
+		{
+			const u64 start = first.dvd_offset;
+			s_coalesce_buffer.resize(end - start);
+			const bool success =
+				ReadFromDisc(start, end - start, s_coalesce_buffer.data(), first.decrypt);
+
+			for (size_t j = i; j < i + count; ++j)
+			{
+				ReadRequest& request = (*requests)[j];
+				std::vector<u8> buffer;
+				if (success)
+				{
+					buffer = GetBuffer(request.length);
+					memcpy(buffer.data(), &s_coalesce_buffer[request.dvd_offset - start], request.length);
+				}
+				PushResult(std::move(request), std::move(buffer));
+			}
+		}
+
+		i += count;
+	}
+}
+
+static void ReadAhead()
+{
+	if (!s_last_read_sequential)
+		return;
+
+	const u64 start = s_last_read_end;
+	const bool decrypt = s_last_read_decrypt;
+	const u64 file_end = GetFileEnd(start, decrypt);
+	if (file_end == 0)
+		return;
+	const u64 end = std::min(file_end, start + READ_AHEAD_WINDOW);
+
+	// Drop the part of the window that has been consumed already.
+	const u64 read_ahead_end = s_read_ahead_offset + s_read_ahead.size();
+	if (decrypt != s_read_ahead_decrypt || start < s_read_ahead_offset || start > read_ahead_end)
+		s_read_ahead.clear();
+	else
+		s_read_ahead.erase(s_read_ahead.begin(), s_read_ahead.begin() + (start - s_read_ahead_offset));
+	s_read_ahead_offset = start;
+	s_read_ahead_decrypt = decrypt;
+
+	const DiscIO::IVolume& volume = DVDInterface::GetVolume();
+	while (s_read_ahead_offset + s_read_ahead.size() < end && s_request_queue.Empty() &&
+		!s_dvd_thread_exiting.IsSet())
+	{
+		const u64 chunk_start = s_read_ahead_offset + s_read_ahead.size();
+		const u32 chunk_length = static_cast<u32>(std::min<u64>(READ_AHEAD_CHUNK, end - chunk_start));
+		const size_t old_size = s_read_ahead.size();
+		s_read_ahead.resize(old_size + chunk_length);
+		if (!volume.Read(chunk_start, chunk_length, &s_read_ahead[old_size], decrypt))
+		{
+			s_read_ahead.resize(old_size);
+			break;
+		}
+	}
 }
 
 static void DVDThread()
 {
 	Common::SetCurrentThreadName("DVD thread");
 
+	s_file_extents.clear();
+	s_file_extents_loaded = false;
+	s_read_ahead.clear();
+	s_read_ahead_offset = 0;
+	s_last_read_end = 0;
+	s_last_read_sequential = false;
+
+	std::vector<ReadRequest> requests;
 	while (true)
 	{
 		s_request_queue_expanded.Wait();
@@ -277,18 +494,19 @@ static void DVDThread()
 		ReadRequest request;
 		while (s_request_queue.Pop(request))
 		{
-			std::vector<u8> buffer(request.length);
-			const DiscIO::IVolume& volume = DVDInterface::GetVolume();
-			if (!volume.Read(request.dvd_offset, request.length, buffer.data(), request.decrypt))
-				buffer.resize(0);
-
-			request.realtime_done_us = Common::Timer::GetTimeUs();
+			// Take everything that is queued, so adjacent requests can be merged.
+			requests.clear();
+			requests.push_back(std::move(request));
+			while (s_request_queue.Pop(request))
+				requests.push_back(std::move(request));
 
-			s_result_queue.Push(ReadResult(std::move(request), std::move(buffer)));
-			s_result_queue_expanded.Set();
+			ProcessRequests(&requests);
 
 			if (s_dvd_thread_exiting.IsSet())
 				return;
+
+			if (s_request_queue.Empty())
+				ReadAhead();
 		}
 	}
 }
@@ -31,6 +31,9 @@
 
 #include "Core/HW/EXI_DeviceSlippi.h"
 #include "Core/HW/SystemTimers.h"
+#ifdef USE_MEMORYWATCHER
+#include "Core/MemorySnapshot.h"
+#endif
 #include "Core/State.h"
 
 #include "Core/GeckoCode.h"
@@ -3235,6 +3238,9 @@ void CEXISlippi::DMAWrite(u32 _uAddr, u32 _uSize)
 			break;
 		case CMD_FRAME_BOOKEND:
 			g_needInputForFrame = true;
+#ifdef USE_MEMORYWATCHER
+			MemorySnapshot::CaptureFrame(Common::swap32(&memPtr[bufLoc + 1]));
+#endif
 			writeToFileAsync(&memPtr[bufLoc], payloadLen + 1, "");
 			m_slippiserver->write(&memPtr[bufLoc], payloadLen + 1);
 			slprs_exi_device_reporter_push_replay_data(slprs_exi_device_ptr, &memPtr[bufLoc], payloadLen + 1);
@@ -147,7 +147,7 @@ int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country car
 
 GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u16 sizeMb,
 	bool shift_jis, DiscIO::Country card_region, int gameId)
-	: MemoryCardBase(slot, sizeMb), m_GameId(gameId), m_LastBlock(-1),
+	: MemoryCardBase(slot, sizeMb), m_GameId(gameId), m_LastBlock(-1), m_LastSaveIndex(-1),
 	m_hdr(slot, sizeMb, shift_jis), m_bat1(sizeMb), m_saves(0), m_SaveDirectory(directory),
 	m_exiting(false)
 {
@@ -334,7 +334,7 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, u8* srcaddress)
 			m_LastBlockAddress = (u8*)&m_bat2;
 			break;
 		default:
-			m_LastBlock = SaveAreaRW(block, true);
+			m_LastBlock = SaveAreaRW(block);
 			if (m_LastBlock == -1)
 			{
 				PanicAlertT("Report: GCIFolder Writing to unallocated block 0x%x", block);
@@ -343,7 +343,12 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, u8* srcaddress)
 		}
 	}
 
-	memcpy(m_LastBlockAddress + offset, srcaddress, length);
+	// Games often rewrite a whole save when only part of it changed, only flag the save for
+	// flushing when its contents actually change.
+	u8* dest = m_LastBlockAddress + offset;
+	if (block >= MC_FST_BLOCKS && memcmp(dest, srcaddress, length) != 0)
+		m_saves[m_LastSaveIndex].m_dirty = true;
+	memcpy(dest, srcaddress, length);
 
 	l.unlock();
 	if (extra)
@@ -483,6 +488,7 @@ inline s32 GCMemcardDirectory::SaveAreaRW(u32 block, bool writing)
 
 				m_LastBlock = block;
 				m_LastBlockAddress = m_saves[i].m_save_data[idx].block;
+				m_LastSaveIndex = i;
 				return m_LastBlock;
 			}
 		}
@@ -544,15 +550,53 @@ bool GCMemcardDirectory::SetUsedBlocks(int saveIndex)
 	return true;
 }
 
+std::string GCMemcardDirectory::NewSaveFilename(const DEntry& header) const
+{
+	std::string filename = m_SaveDirectory + header.GCI_FileName();
+
+	// Check to see if another file is using the same name
+	// This seems unlikely except in the case of file corruption
+	// otherwise what user would name another file this way?
+	for (int j = 0; File::Exists(filename) && j < 10; ++j)
+	{
+		filename.insert(filename.end() - 4, '0');
+	}
+	if (File::Exists(filename))
+		PanicAlertT("Failed to find new filename.\n%s\n will be overwritten", filename.c_str());
+	return filename;
+}
+
+bool GCMemcardDirectory::WriteGCI(const PendingFlush& flush) const
+{
+	// Write the whole file next to the old one and swap them, so the save on disk is never
+	// left half written if we crash or run out of space.
+	const std::string temp_filename = flush.filename + ".tmp";
+	{
+		File::IOFile GCI(temp_filename, "wb");
+		if (!GCI || !GCI.WriteBytes(&flush.header, DENTRY_SIZE) ||
+			!GCI.WriteBytes(flush.save_data.data(), BLOCK_SIZE * flush.save_data.size()) ||
+			!GCI.Flush())
+		{
+			GCI.Close();
+			File::Delete(temp_filename);
+			return false;
+		}
+	}
+	return File::Rename(temp_filename, flush.filename);
+}
+
+// The card state is copied out under m_write_mutex and written to disk without holding it,
+// so the CPU thread never waits on disk I/O when it accesses the card during a flush.
 void GCMemcardDirectory::FlushToFile()
 {
-	std::unique_lock<std::mutex> l(m_write_mutex);
-	int errors = 0;
-	DEntry invalid;
-	for (u16 i = 0; i < m_saves.size(); ++i)
+	std::vector<PendingFlush> flushes;
 	{
-		if (m_saves[i].m_dirty)
+		std::unique_lock<std::mutex> l(m_write_mutex);
+		for (u16 i = 0; i < m_saves.size(); ++i)
 		{
+			if (!m_saves[i].m_dirty)
+				continue;
+
 			if (BE32(m_saves[i].m_gci_header.Gamecode) != 0xFFFFFFFF)
 			{
 				m_saves[i].m_dirty = false;
@@ -565,72 +609,91 @@ void GCMemcardDirectory::FlushToFile()
 						"GCI header modified without corresponding save data changes");
 					continue;
 				}
-				if (m_saves[i].m_filename.empty())
-				{
-					std::string defaultSaveName = m_SaveDirectory + m_saves[i].m_gci_header.GCI_FileName();
-
-					// Check to see if another file is using the same name
-					// This seems unlikely except in the case of file corruption
-					// otherwise what user would name another file this way?
-					for (int j = 0; File::Exists(defaultSaveName) && j < 10; ++j)
-					{
-						defaultSaveName.insert(defaultSaveName.end() - 4, '0');
-					}
-					if (File::Exists(defaultSaveName))
-						PanicAlertT("Failed to find new filename.\n%s\n will be overwritten",
-							defaultSaveName.c_str());
-					m_saves[i].m_filename = defaultSaveName;
-				}
-				File::IOFile GCI(m_saves[i].m_filename, "wb");
-				if (GCI)
-				{
-					GCI.WriteBytes(&m_saves[i].m_gci_header, DENTRY_SIZE);
-					GCI.WriteBytes(m_saves[i].m_save_data.data(), BLOCK_SIZE * m_saves[i].m_save_data.size());
-
-					if (GCI.IsGood())
-					{
-						Core::DisplayMessage(
-							StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
-					}
-					else
-					{
-						++errors;
-						Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
-							m_saves[i].m_filename.c_str()),
-							4000);
-						ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s",
-							m_saves[i].m_filename.c_str());
-					}
-				}
+				flushes.push_back({ i, false, m_saves[i].m_filename, m_saves[i].m_gci_header,
+					m_saves[i].m_save_data, false });
 			}
 			else if (m_saves[i].m_filename.length() != 0)
 			{
 				m_saves[i].m_dirty = false;
-				std::string& oldname = m_saves[i].m_filename;
-				std::string deletedname = oldname + ".deleted";
-				if (File::Exists(deletedname))
-					File::Delete(deletedname);
-				File::Rename(oldname, deletedname);
+				flushes.push_back({ i, true, m_saves[i].m_filename, m_saves[i].m_gci_header, {}, false });
 				m_saves[i].m_filename.clear();
 				m_saves[i].m_save_data.clear();
 				m_saves[i].m_used_blocks.clear();
 			}
 		}
+	}
+
+	int errors = 0;
+	for (PendingFlush& flush : flushes)
+	{
+		if (flush.remove)
+		{
+			std::string deletedname = flush.filename + ".deleted";
+			if (File::Exists(deletedname))
+				File::Delete(deletedname);
+			File::Rename(flush.filename, deletedname);
+			continue;
+		}
+
+		if (flush.filename.empty())
+			flush.filename = NewSaveFilename(flush.header);
 
+		if (WriteGCI(flush))
+		{
+			Core::DisplayMessage(
+				StringFromFormat("Wrote save contents to %s", flush.filename.c_str()), 4000);
+		}
+		else
+		{
+			++errors;
+			flush.failed = true;
+			Core::DisplayMessage(
+				StringFromFormat("Failed to write save contents to %s", flush.filename.c_str()), 4000);
+			ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s", flush.filename.c_str());
+		}
+	}
+
+	std::unique_lock<std::mutex> l(m_write_mutex);
+	for (const PendingFlush& flush : flushes)
+	{
+		// The saves may have been replaced by loading a state in the meantime.
+		if (flush.remove || flush.index >= m_saves.size())
+			continue;
+		GCIFile& save = m_saves[flush.index];
+		if (save.m_gci_header.GCI_FileName() != flush.header.GCI_FileName())
+			continue;
+
+		if (save.m_filename.empty())
+			save.m_filename = flush.filename;
+		// Try again on the next flush rather than losing the changes.
+		if (flush.failed)
+			save.m_dirty = true;
+	}
+
+	for (u16 i = 0; i < m_saves.size(); ++i)
+	{
 		// Unload the save data for any game that is not running
 		// we could use !m_dirty, but some games have multiple gci files and may not write to them
 		// simultaneously
 		// this ensures that the save data for all of the current games gci files are stored in the
 		// savestate
+		// Saves which still have changes that aren't on disk are kept until they are.
 		u32 gamecode = BE32(m_saves[i].m_gci_header.Gamecode);
-		if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size())
+		if (gamecode != m_GameId && gamecode != 0xFFFFFFFF && m_saves[i].m_save_data.size() &&
+			!m_saves[i].m_dirty && !m_saves[i].m_filename.empty())
 		{
 			INFO_LOG(EXPANSIONINTERFACE, "Flushing savedata to disk for %s",
 				m_saves[i].m_filename.c_str());
 			m_saves[i].m_save_data.clear();
+			if (m_LastSaveIndex == i)
+			{
+				m_LastBlock = -1;
+				m_LastSaveIndex = -1;
+			}
 		}
 	}
 #if _WRITE_MC_HEADER
+	l.unlock();
 	u8 mc[BLOCK_SIZE * MC_FST_BLOCKS];
 	Read(0, BLOCK_SIZE * MC_FST_BLOCKS, mc);
 	File::IOFile hdrfile(m_SaveDirectory + MC_HDR, "wb");
@@ -643,6 +706,7 @@ void GCMemcardDirectory::DoState(PointerWrap& p)
 	std::unique_lock<std::mutex> l(m_write_mutex);
 	m_LastBlock = -1;
 	m_LastBlockAddress = nullptr;
+	m_LastSaveIndex = -1;
 	p.Do(m_SaveDirectory);
 	p.DoPOD<Header>(m_hdr);
 	p.DoPOD<Directory>(m_dir1);
@@ -42,9 +42,25 @@ private:
 	inline void SyncSaves();
 	bool SetUsedBlocks(int saveIndex);
 
+	// What FlushToFile took out of m_saves under m_write_mutex, written without holding it.
+	struct PendingFlush
+	{
+		u16 index;
+		bool remove;
+		std::string filename;  // Empty for saves which don't have a file yet
+		DEntry header;
+		std::vector<GCMBlock> save_data;
+		bool failed;
+	};
+
+	std::string NewSaveFilename(const DEntry& header) const;
+	bool WriteGCI(const PendingFlush& flush) const;
+
 	u32 m_GameId;
 	s32 m_LastBlock;
 	u8* m_LastBlockAddress;
+	// Save of m_LastBlock when it is a save block, so writes to it mark the save dirty.
+	s32 m_LastSaveIndex;
 
 	Header m_hdr;
 	Directory m_dir1, m_dir2;
@@ -141,6 +141,7 @@ const std::string hotkey_labels[] = {
 		_trans("Undo Save State"),
 		_trans("Save State"),
 		_trans("Load State"),
+		_trans("Rewind"),
 		_trans("Reload Post-Processing Shaders"),
 
 		_trans("Jump Backwards 5 Seconds"),
@@ -0,0 +1,211 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemorySnapshot.h"
+#include "Core/Movie.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace MemorySnapshot
+{
+static const u32 MIN_SLOT_COUNT = 2;
+static const auto BACK_PRESSURE_TIMEOUT = std::chrono::seconds(1);
+
+static std::string s_shared_name;
+static u8* s_shared = nullptr;
+static size_t s_shared_size;
+static u8* s_slots;
+
+// Host pointers to the ranges, resolved once as RAM doesn't move while the game runs.
+static std::vector<const u8*> s_pointers;
+static std::vector<Range> s_ranges;
+
+// Set when the consumer didn't make room in time, until it reads again. Until then frames are
+// dropped without waiting, so a dead consumer doesn't hold every frame for the whole timeout.
+static bool s_consumer_stalled;
+static u64 s_stalled_read_count;
+
+static bool LoadRanges(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::stringstream ss(line);
+		Range range;
+		if (!(ss >> std::hex >> range.address >> range.length) || range.length == 0)
+			continue;
+
+		// Ranges must be backed by one contiguous host mapping.
+		const u32 last_address = range.address + range.length - 1;
+		const u8* first = nullptr;
+		if (last_address >= range.address && PowerPC::HostIsRAMAddress(range.address) &&
+			PowerPC::HostIsRAMAddress(last_address))
+		{
+			first = Memory::GetPointer(range.address);
+		}
+		if (!first || Memory::GetPointer(last_address) != first + range.length - 1)
+		{
+			ERROR_LOG(MEMMAP, "MemorySnapshot: invalid range %08x+%x", range.address, range.length);
+			continue;
+		}
+
+		s_ranges.push_back(range);
+		s_pointers.push_back(first);
+	}
+	return !s_ranges.empty();
+}
+
+void Init()
+{
+	const std::string& name = SConfig::GetInstance().m_strMemorySnapshotSharedMemory;
+	if (name.empty())
+		return;
+
+	if (!LoadRanges(File::GetUserPath(D_MEMORYWATCHER_IDX) + MEMORYWATCHER_SNAPSHOT))
+	{
+		ERROR_LOG(MEMMAP, "MemorySnapshot: no ranges to capture");
+		Shutdown();
+		return;
+	}
+
+	size_t data_size = 0;
+	for (const Range& range : s_ranges)
+		data_size += range.length;
+	const size_t slot_size = (sizeof(SlotHeader) + data_size + 63) & ~size_t(63);
+	const u32 slot_count =
+		std::max<u32>(MIN_SLOT_COUNT, SConfig::GetInstance().iMemorySnapshotSlots);
+	const size_t ranges_size = (s_ranges.size() * sizeof(Range) + 63) & ~size_t(63);
+	const size_t header_size = (sizeof(SharedHeader) + 63) & ~size_t(63);
+	const size_t size = header_size + ranges_size + slot_count * slot_size;
+
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+	if (fd < 0)
+	{
+		ERROR_LOG(MEMMAP, "MemorySnapshot: shm_open(%s) failed: %s", name.c_str(), strerror(errno));
+		Shutdown();
+		return;
+	}
+
+	void* shared = MAP_FAILED;
+	if (ftruncate(fd, size) == 0)
+		shared = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shared == MAP_FAILED)
+	{
+		ERROR_LOG(MEMMAP, "MemorySnapshot: failed to map %s: %s", name.c_str(), strerror(errno));
+		shm_unlink(name.c_str());
+		Shutdown();
+		return;
+	}
+
+	s_shared_name = name;
+	s_shared = static_cast<u8*>(shared);
+	s_shared_size = size;
+	s_slots = s_shared + header_size + ranges_size;
+	s_consumer_stalled = false;
+
+	memset(s_shared, 0, size);
+	memcpy(s_shared + header_size, s_ranges.data(), s_ranges.size() * sizeof(Range));
+	SharedHeader* header = reinterpret_cast<SharedHeader*>(s_shared);
+	header->range_count = static_cast<u32>(s_ranges.size());
+	header->slot_count = slot_count;
+	header->slot_size = static_cast<u32>(slot_size);
+	// Consumers check the magic last, so publish it after everything else.
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = SHARED_MAGIC;
+
+	INFO_LOG(MEMMAP, "MemorySnapshot: capturing %zu ranges (%zu bytes) per frame to %s",
+		s_ranges.size(), data_size, name.c_str());
+}
+
+void Shutdown()
+{
+	if (s_shared)
+	{
+		munmap(s_shared, s_shared_size);
+		shm_unlink(s_shared_name.c_str());
+		s_shared = nullptr;
+	}
+	s_ranges.clear();
+	s_pointers.clear();
+}
+
+// Returns false if the consumer didn't make room in time.
+static bool WaitForConsumer(SharedHeader* header, u64 write_count)
+{
+	const auto deadline = std::chrono::steady_clock::now() + BACK_PRESSURE_TIMEOUT;
+	while (write_count - header->read_count.load(std::memory_order_acquire) >= header->slot_count)
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void CaptureFrame(s32 frame)
+{
+	if (!s_shared)
+		return;
+
+	SharedHeader* header = reinterpret_cast<SharedHeader*>(s_shared);
+	const u64 write_count = header->write_count.load(std::memory_order_relaxed);
+	const u64 read_count = header->read_count.load(std::memory_order_acquire);
+	if (s_consumer_stalled && read_count != s_stalled_read_count)
+		s_consumer_stalled = false;
+	if (write_count - read_count >= header->slot_count)
+	{
+		bool has_room = false;
+		if (SConfig::GetInstance().bMemorySnapshotBackPressure && !s_consumer_stalled)
+		{
+			has_room = WaitForConsumer(header, write_count);
+			if (!has_room)
+			{
+				WARN_LOG(MEMMAP, "MemorySnapshot: consumer stalled, dropping frames until it reads again");
+				s_consumer_stalled = true;
+				s_stalled_read_count = header->read_count.load(std::memory_order_acquire);
+			}
+		}
+		if (!has_room)
+		{
+			header->dropped_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	u8* slot = s_slots + (write_count % header->slot_count) * header->slot_size;
+	SlotHeader slot_header = { frame, 0, Movie::GetCurrentFrame() };
+	memcpy(slot, &slot_header, sizeof(slot_header));
+
+	u8* data = slot + sizeof(SlotHeader);
+	for (size_t i = 0; i < s_ranges.size(); ++i)
+	{
+		memcpy(data, s_pointers[i], s_ranges[i].length);
+		data += s_ranges[i].length;
+	}
+
+	header->write_count.store(write_count + 1, std::memory_order_release);
+}
+}
@@ -0,0 +1,64 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+
+// MemorySnapshot copies a fixed set of RAM ranges once per game frame into a ring in
+// POSIX shared memory, for consumers which need every frame and a consistent view of it
+// (MemoryWatcher samples at its own rate, possibly in the middle of a frame).
+//
+// It is enabled by setting Core/MemorySnapshotSharedMemory to the shared memory name,
+// e.g. "/dolphin-snapshot". The ranges are read from Snapshot.txt in the MemoryWatcher
+// directory, one "address length" pair in hex per line. Frames are captured when the
+// game sends the Slippi frame bookend, at the same point replays record frame data.
+//
+// The shared memory holds a SharedHeader, range_count Ranges, then slot_count slots of
+// slot_size bytes: a SlotHeader followed by the ranges' bytes back to back. The header,
+// the range table and every slot start on a 64 byte boundary.
+//
+// It is a single producer, single consumer ring: snapshot n lives in slot n % slot_count
+// and is readable once write_count > n. The consumer stores how many snapshots it has
+// consumed in read_count. When the ring is full, the frame is dropped and counted in
+// dropped_count, or with Core/MemorySnapshotBackPressure the emulation waits for the
+// consumer. It waits for at most a second, so a dead consumer can't hang it, and then drops
+// frames without waiting until the consumer reads again.
+namespace MemorySnapshot
+{
+static constexpr u32 SHARED_MAGIC = 0x31534D53;  // "SMS1"
+
+struct SharedHeader
+{
+	u32 magic;
+	u32 range_count;
+	u32 slot_count;
+	u32 slot_size;
+	std::atomic<u64> write_count;
+	std::atomic<u64> read_count;  // Written by the consumer
+	std::atomic<u64> dropped_count;
+};
+
+struct Range
+{
+	u32 address;
+	u32 length;
+};
+
+struct SlotHeader
+{
+	s32 frame;  // Game frame from the bookend
+	u32 padding;
+	u64 vi_frame;  // Movie::GetCurrentFrame()
+};
+
+// Both run on the CPU thread, around the CPU loop.
+void Init();
+void Shutdown();
+
+// Called on the CPU thread at the end of every game frame.
+void CaptureFrame(s32 frame);
+}
@@ -2,22 +2,32 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
-#include <iostream>
 #include <memory>
 #include <sstream>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/MemoryWatcher.h"
+#include "Core/Movie.h"
 
 static std::unique_ptr<MemoryWatcher> s_memory_watcher;
 static CoreTiming::EventType* s_event;
 static const int MW_RATE = 600;  // Steps per second
 
+// Keep binary datagrams well below the default socket buffer size.
+static const size_t MAX_RECORDS_PER_DATAGRAM = 4096;
+
 static void MWCallback(u64 userdata, s64 cyclesLate)
 {
   s_memory_watcher->Step();
@@ -38,22 +48,35 @@ void MemoryWatcher::Shutdown()
 }
 
 MemoryWatcher::MemoryWatcher()
+    : m_running(false), m_fd(-1), m_binary(SConfig::GetInstance().bMemoryWatcherBinary),
+      m_step(0), m_shared(nullptr), m_shared_size(0)
 {
-  m_running = false;
   if (!LoadAddresses(File::GetUserPath(F_MEMORYWATCHERLOCATIONS_IDX)))
     return;
-  if (!OpenSocket(File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX)))
+
+  const std::string& shared_name = SConfig::GetInstance().m_strMemoryWatcherSharedMemory;
+  if (!shared_name.empty())
+  {
+    if (!OpenSharedMemory(shared_name))
+      return;
+  }
+  else if (!OpenSocket(File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX)))
+  {
     return;
+  }
   m_running = true;
 }
 
 MemoryWatcher::~MemoryWatcher()
 {
-  if (!m_running)
-    return;
+  if (m_fd >= 0)
+    close(m_fd);
 
-  m_running = false;
-  close(m_fd);
+  if (m_shared)
+  {
+    munmap(m_shared, m_shared_size);
+    shm_unlink(m_shared_name.c_str());
+  }
 }
 
 bool MemoryWatcher::LoadAddresses(const std::string& path)
@@ -66,19 +89,31 @@ bool MemoryWatcher::LoadAddresses(const std::string& path)
   while (std::getline(locations, line))
     ParseLine(line);
 
-  return m_values.size() > 0;
+  return m_watches.size() > 0;
 }
 
 void MemoryWatcher::ParseLine(const std::string& line)
 {
-  m_values[line] = 0;
-  m_addresses[line] = std::vector<u32>();
+  // Each line is only watched once, however many times it appears.
+  if (std::any_of(m_watches.begin(), m_watches.end(),
+                  [&line](const Watch& watch) { return watch.line == line; }))
+  {
+    return;
+  }
+
+  Watch watch;
+  watch.line = line;
+  watch.first_offset = static_cast<u32>(m_offsets.size());
+  watch.value = 0;
 
   std::stringstream offsets(line);
   offsets >> std::hex;
   u32 offset;
   while (offsets >> offset)
-    m_addresses[line].push_back(offset);
+    m_offsets.push_back(offset);
+
+  watch.offset_count = static_cast<u32>(m_offsets.size()) - watch.first_offset;
+  m_watches.push_back(std::move(watch));
 }
 
 bool MemoryWatcher::OpenSocket(const std::string& path)
@@ -91,19 +126,107 @@ bool MemoryWatcher::OpenSocket(const std::string& path)
   return m_fd >= 0;
 }
 
-u32 MemoryWatcher::ChasePointer(const std::string& line)
+bool MemoryWatcher::OpenSharedMemory(const std::string& name)
+{
+  const size_t slot_size =
+      (sizeof(SharedSlot) + m_watches.size() * sizeof(u32) + alignof(SharedSlot) - 1) &
+      ~(alignof(SharedSlot) - 1);
+  const size_t size = sizeof(SharedHeader) + SHARED_SLOT_COUNT * slot_size;
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd < 0)
+  {
+    ERROR_LOG(COMMON, "MemoryWatcher: shm_open(%s) failed: %s", name.c_str(), strerror(errno));
+    return false;
+  }
+
+  void* shared = MAP_FAILED;
+  if (ftruncate(fd, size) == 0)
+    shared = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (shared == MAP_FAILED)
+  {
+    ERROR_LOG(COMMON, "MemoryWatcher: failed to map %s: %s", name.c_str(), strerror(errno));
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  m_shared_name = name;
+  m_shared = static_cast<u8*>(shared);
+  m_shared_size = size;
+
+  // Readers check the magic last, so publish it after everything else.
+  memset(m_shared, 0, size);
+  SharedHeader* header = reinterpret_cast<SharedHeader*>(m_shared);
+  header->watch_count = static_cast<u32>(m_watches.size());
+  header->slot_count = SHARED_SLOT_COUNT;
+  header->slot_size = static_cast<u32>(slot_size);
+  header->write_count.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = SHARED_MAGIC;
+  return true;
+}
+
+u32 MemoryWatcher::ChasePointer(const Watch& watch) const
 {
   u32 value = 0;
-  for (u32 offset : m_addresses[line])
-    value = Memory::Read_U32(value + offset);
+  const u32* offsets = &m_offsets[watch.first_offset];
+  for (u32 i = 0; i < watch.offset_count; ++i)
+    value = Memory::Read_U32(value + offsets[i]);
   return value;
 }
 
-std::string MemoryWatcher::ComposeMessage(const std::string& line, u32 value)
+void MemoryWatcher::SendText(const Watch& watch)
+{
+  // The line, a newline, the value in hex and a null terminator.
+  m_message.resize(watch.line.size() + 10);
+  int length = snprintf(reinterpret_cast<char*>(m_message.data()), m_message.size(), "%s\n%x",
+                        watch.line.c_str(), watch.value);
+  sendto(m_fd, m_message.data(), length + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
+         sizeof(m_addr));
+}
+
+void MemoryWatcher::SendBinary()
+{
+  const u64 frame = Movie::GetCurrentFrame();
+  for (size_t first = 0; first < m_changed.size(); first += MAX_RECORDS_PER_DATAGRAM)
+  {
+    const size_t count = std::min(m_changed.size() - first, MAX_RECORDS_PER_DATAGRAM);
+    m_message.resize(sizeof(BinaryHeader) + count * sizeof(BinaryRecord));
+
+    BinaryHeader header = {BINARY_MAGIC, static_cast<u32>(count), m_step, frame};
+    memcpy(m_message.data(), &header, sizeof(header));
+    BinaryRecord* records = reinterpret_cast<BinaryRecord*>(m_message.data() + sizeof(header));
+    for (size_t i = 0; i < count; ++i)
+    {
+      const u32 index = m_changed[first + i];
+      BinaryRecord record = {index, m_watches[index].value};
+      memcpy(&records[i], &record, sizeof(record));
+    }
+
+    sendto(m_fd, m_message.data(), m_message.size(), 0, reinterpret_cast<sockaddr*>(&m_addr),
+           sizeof(m_addr));
+  }
+}
+
+void MemoryWatcher::PublishSnapshot()
 {
-  std::stringstream message_stream;
-  message_stream << line << '\n' << std::hex << value;
-  return message_stream.str();
+  SharedHeader* header = reinterpret_cast<SharedHeader*>(m_shared);
+  const u64 count = header->write_count.load(std::memory_order_relaxed);
+  SharedSlot* slot = reinterpret_cast<SharedSlot*>(m_shared + sizeof(SharedHeader) +
+                                                   (count % SHARED_SLOT_COUNT) * header->slot_size);
+
+  slot->sequence.store(2 * count + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->step = m_step;
+  slot->frame = Movie::GetCurrentFrame();
+  u32* values = reinterpret_cast<u32*>(slot + 1);
+  for (size_t i = 0; i < m_watches.size(); ++i)
+    values[i] = m_watches[i].value;
+
+  slot->sequence.store(2 * count + 2, std::memory_order_release);
+  header->write_count.store(count + 1, std::memory_order_release);
 }
 
 void MemoryWatcher::Step()
@@ -111,19 +234,28 @@ void MemoryWatcher::Step()
   if (!m_running)
     return;
 
-  for (auto& entry : m_values)
+  m_changed.clear();
+  for (u32 i = 0; i < m_watches.size(); ++i)
   {
-    std::string address = entry.first;
-    u32& current_value = entry.second;
+    Watch& watch = m_watches[i];
+    u32 new_value = ChasePointer(watch);
+    if (new_value == watch.value)
+      continue;
 
-    u32 new_value = ChasePointer(address);
-    if (new_value != current_value)
-    {
-      // Update the value
-      current_value = new_value;
-      std::string message = ComposeMessage(address, new_value);
-      sendto(m_fd, message.c_str(), message.size() + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
-             sizeof(m_addr));
-    }
+    watch.value = new_value;
+    if (m_shared)
+      continue;
+
+    if (m_binary)
+      m_changed.push_back(i);
+    else
+      SendText(watch);
   }
+
+  if (m_shared)
+    PublishSnapshot();
+  else if (!m_changed.empty())
+    SendBinary();
+
+  ++m_step;
 }
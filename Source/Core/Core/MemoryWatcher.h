@@ -4,11 +4,14 @@
 
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <string>
 #include <vector>
 #include <sys/socket.h>
 #include <sys/un.h>
 
+#include "Common/CommonTypes.h"
+
 // MemoryWatcher reads a file containing in-game memory addresses and outputs
 // changes to those memory addresses to a unix domain socket as the game runs.
 //
@@ -17,6 +20,17 @@
 // "ABCD EF" will watch the address at (*0xABCD) + 0xEF.
 // The output to the socket is two lines. The first is the address from the
 // input file, and the second is the new value in hex.
+//
+// With Core/MemoryWatcherBinary set, every step that changed something instead sends a
+// single datagram made of a BinaryHeader followed by one BinaryRecord per changed value.
+// Watches are numbered in the order they first appear in the input file.
+//
+// With Core/MemoryWatcherSharedMemory set to a POSIX shared memory name (e.g.
+// "/dolphin-memorywatcher"), nothing is sent to the socket. Every step publishes a
+// snapshot of all the values to a ring of SharedSlots in that object instead, following
+// a SharedHeader. A reader takes the slot of snapshot write_count - 1 and copies it out,
+// and the copy is consistent if the slot's sequence was 2 * write_count both before and
+// after the copy.
 class MemoryWatcher final
 {
 public:
@@ -27,21 +41,78 @@ public:
 	static void Init();
 	static void Shutdown();
 
+	static constexpr u32 BINARY_MAGIC = 0x3142574D;  // "MWB1"
+	static constexpr u32 SHARED_MAGIC = 0x3153574D;  // "MWS1"
+	static constexpr u32 SHARED_SLOT_COUNT = 64;
+
+#pragma pack(push, 1)
+	struct BinaryHeader
+	{
+		u32 magic;
+		u32 count;  // Number of BinaryRecords following
+		u64 step;   // Increases by one every step, 600 steps per emulated second
+		u64 frame;  // Movie::GetCurrentFrame()
+	};
+
+	struct BinaryRecord
+	{
+		u32 index;
+		u32 value;
+	};
+#pragma pack(pop)
+
+	struct SharedHeader
+	{
+		u32 magic;
+		u32 watch_count;
+		u32 slot_count;
+		u32 slot_size;  // In bytes, including the values
+		std::atomic<u64> write_count;
+	};
+
+	// Followed by watch_count u32 values.
+	struct SharedSlot
+	{
+		std::atomic<u64> sequence;  // Odd while the slot is being written
+		u64 step;
+		u64 frame;
+	};
+
 private:
+	// A line of the input file, its pointer chain stored in m_offsets.
+	struct Watch
+	{
+		std::string line;
+		u32 first_offset;
+		u32 offset_count;
+		u32 value;
+	};
+
 	bool LoadAddresses(const std::string& path);
 	bool OpenSocket(const std::string& path);
+	bool OpenSharedMemory(const std::string& name);
 
 	void ParseLine(const std::string& line);
-	u32 ChasePointer(const std::string& line);
-	std::string ComposeMessage(const std::string& line, u32 value);
+	u32 ChasePointer(const Watch& watch) const;
+
+	void SendText(const Watch& watch);
+	void SendBinary();
+	void PublishSnapshot();
 
 	bool m_running;
 
 	int m_fd;
 	sockaddr_un m_addr;
+	bool m_binary;
+
+	std::vector<Watch> m_watches;
+	std::vector<u32> m_offsets;
+	u64 m_step;
+
+	std::vector<u8> m_message;
+	std::vector<u32> m_changed;
 
-	// Address as stored in the file -> list of offsets to follow
-	std::map<std::string, std::vector<u32>> m_addresses;
-	// Address as stored in the file -> current value
-	std::map<std::string, u32> m_values;
+	std::string m_shared_name;
+	u8* m_shared;
+	size_t m_shared_size;
 };
@@ -17,9 +17,10 @@ void CachedInterpreter::Init()
 {
 	m_code.reserve(CODE_SIZE / sizeof(Instruction));
 
-	jo.enableBlocklink = false;
+	jo.enableBlocklink = !SConfig::GetInstance().bJITNoBlockLinking;
 
 	JitBaseBlockCache::Init();
+	UpdateMemoryOptions();
 
 	code_block.m_stats = &js.st;
 	code_block.m_gpa = &js.gpa;
@@ -35,50 +36,71 @@ void CachedInterpreter::Run()
 {
 	while (!CPU::GetState())
 	{
-		SingleStep();
+		ExecuteBlocks(true);
 	}
 }
 
 void CachedInterpreter::SingleStep()
+{
+	ExecuteBlocks(false);
+}
+
+void CachedInterpreter::ExecuteBlocks(bool follow_links)
 {
 	int block = GetBlockNumberFromStartAddress(PC);
-	if (block >= 0)
+	if (block < 0)
 	{
-		Instruction* code = (Instruction*)GetCompiledCodeFromBlock(block);
+		Jit(PC);
+		return;
+	}
 
-		while (true)
+	const Instruction* code = (const Instruction*)GetCompiledCodeFromBlock(block);
+	while (true)
+	{
+		switch (code->type)
 		{
-			switch (code->type)
-			{
-			case Instruction::INSTRUCTION_ABORT:
-				return;
+		case Instruction::INSTRUCTION_ABORT:
+			return;
 
-			case Instruction::INSTRUCTION_TYPE_COMMON:
-				code->common_callback(UGeckoInstruction(code->data));
-				code++;
-				break;
+		case Instruction::INSTRUCTION_TYPE_COMMON:
+			code->common_callback(UGeckoInstruction(code->data));
+			code++;
+			break;
+
+		case Instruction::INSTRUCTION_TYPE_COMMON_PAIR:
+			code[0].common_callback(UGeckoInstruction(code[0].data));
+			code[1].common_callback(UGeckoInstruction(code[1].data));
+			code += 2;
+			break;
+
+		case Instruction::INSTRUCTION_TYPE_CONDITIONAL:
+			if (code->conditional_callback(code->data))
+				return;
+			code++;
+			break;
 
-			case Instruction::INSTRUCTION_TYPE_CONDITIONAL:
-				bool ret = code->conditional_callback(code->data);
+		case Instruction::INSTRUCTION_TYPE_LINK:
+			// EndBlock already returned if the timeslice ran out, so the CPU state is still
+			// checked at least once per timeslice.
+			if (follow_links && code->link && PC == code->data)
+				code = code->link;
+			else
 				code++;
-				if (ret)
-					return;
-				break;
-			}
+			break;
 		}
 	}
-
-	Jit(PC);
 }
 
-static void EndBlock(UGeckoInstruction data)
+static bool EndBlock(u32 data)
 {
 	PC = NPC;
-	PowerPC::ppcState.downcount -= data.hex;
+	PowerPC::ppcState.downcount -= data;
 	if (PowerPC::ppcState.downcount <= 0)
 	{
 		CoreTiming::Advance();
+		return true;
 	}
+	return false;
 }
 
 static void WritePC(UGeckoInstruction data)
@@ -87,6 +109,13 @@ static void WritePC(UGeckoInstruction data)
 	NPC = data.hex + 4;
 }
 
+static void CheckIdle(UGeckoInstruction data)
+{
+	// The branch closes an idle loop, and was taken.
+	if (NPC == data.hex)
+		CoreTiming::Idle();
+}
+
 static bool CheckFPU(u32 data)
 {
 	UReg_MSR& msr = (UReg_MSR&)MSR;
@@ -100,6 +129,46 @@ static bool CheckFPU(u32 data)
 	return false;
 }
 
+static bool CheckDSI(u32 data)
+{
+	if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+	{
+		PC = NPC = data;
+		PowerPC::CheckExceptions();
+		return true;
+	}
+	return false;
+}
+
+void CachedInterpreter::WriteExit(u32 destination)
+{
+	if (!jo.enableBlocklink)
+		return;
+
+	JitBlock::LinkData linkData;
+	linkData.exitAddress = destination;
+	linkData.exitPtrs = (u8*)GetCodePtr();
+	linkData.linkStatus = false;
+	js.curBlock->linkData.push_back(linkData);
+
+	m_code.emplace_back(destination);
+}
+
+void CachedInterpreter::FuseInstructions(size_t start)
+{
+	// Adjacent interpreter calls are dispatched in pairs. Checks and exits decide where
+	// execution continues, so they stay on their own.
+	for (size_t i = start; i + 1 < m_code.size(); i++)
+	{
+		if (m_code[i].type == Instruction::INSTRUCTION_TYPE_COMMON &&
+			m_code[i + 1].type == Instruction::INSTRUCTION_TYPE_COMMON)
+		{
+			m_code[i].type = Instruction::INSTRUCTION_TYPE_COMMON_PAIR;
+			i++;
+		}
+	}
+}
+
 void CachedInterpreter::Jit(u32 address)
 {
 	if (m_code.size() >= CODE_SIZE / sizeof(Instruction) - 0x1000 || IsFull() || SConfig::GetInstance().bJITNoBlockCache)
@@ -129,6 +198,7 @@ void CachedInterpreter::Jit(u32 address)
 
 	PPCAnalyst::CodeOp *ops = code_buffer.codebuffer;
 
+	const size_t start = m_code.size();
 	b->checkedEntry = GetCodePtr();
 	b->normalEntry = GetCodePtr();
 	b->runCount = 0;
@@ -169,16 +239,32 @@ void CachedInterpreter::Jit(u32 address)
 			if (ops[i].opinfo->flags & FL_ENDBLOCK)
 				m_code.emplace_back(WritePC, ops[i].address);
 			m_code.emplace_back(GetInterpreterOp(ops[i].inst), ops[i].inst);
+			// Only loads and stores can raise a DSI, and only with MMU or memory checks on.
+			if (jo.memcheck && (ops[i].opinfo->flags & FL_LOADSTORE))
+				m_code.emplace_back(CheckDSI, ops[i].address);
+			if (ops[i].branchIsIdleLoop && CPU::GetState() != CPU::CPU_STEPPING)
+			{
+				m_code.emplace_back(CheckIdle, js.blockStart);
+				b->idleLoop = true;
+			}
 			if (ops[i].opinfo->flags & FL_ENDBLOCK)
+			{
 				m_code.emplace_back(EndBlock, js.downcountAmount);
+				if (ops[i].inst.OPCD == 16 || ops[i].inst.OPCD == 18)
+					WriteExit(ops[i].branchTo);
+				if (ops[i].inst.OPCD == 16)
+					WriteExit(ops[i].address + 4);
+			}
 		}
 	}
 	if (code_block.m_broken)
 	{
 		m_code.emplace_back(WritePC, nextPC);
 		m_code.emplace_back(EndBlock, js.downcountAmount);
+		WriteExit(nextPC);
 	}
 	m_code.emplace_back();
+	FuseInstructions(start);
 
 	b->codeSize = (u32)(GetCodePtr() - b->checkedEntry);
 	b->originalSize = code_block.m_num_instructions;
@@ -188,14 +274,21 @@ void CachedInterpreter::Jit(u32 address)
 
 void CachedInterpreter::ClearCache()
 {
-	m_code.clear();
+	// Destroying the blocks writes to their code, so it goes first.
 	JitBaseBlockCache::Clear();
+	m_code.clear();
+	UpdateMemoryOptions();
 }
 
 void CachedInterpreter::WriteDestroyBlock(const u8* location, u32 address)
 {
+	// Blocks still linked here go back to the dispatcher instead.
+	Instruction* code = (Instruction*)location;
+	code->type = Instruction::INSTRUCTION_ABORT;
 }
 
 void CachedInterpreter::WriteLinkBlock(u8* location, const JitBlock& block)
 {
+	Instruction* code = (Instruction*)location;
+	code->link = (const Instruction*)block.checkedEntry;
 }
@@ -50,22 +50,31 @@ private:
 		Instruction() : type(INSTRUCTION_ABORT) {};
 		Instruction(const CommonCallback c, UGeckoInstruction i) : common_callback(c), data(i.hex), type(INSTRUCTION_TYPE_COMMON) {};
 		Instruction(const ConditionalCallback c, u32 d) : conditional_callback(c), data(d), type(INSTRUCTION_TYPE_CONDITIONAL) {};
+		// An exit to address, followed when the block there is linked and the exit is taken.
+		explicit Instruction(u32 address) : link(nullptr), data(address), type(INSTRUCTION_TYPE_LINK) {};
 
 		union
 		{
 			const CommonCallback common_callback;
 			const ConditionalCallback conditional_callback;
-
+			const Instruction* link;
 		};
 		u32 data;
 		enum
 		{
 			INSTRUCTION_ABORT,
 			INSTRUCTION_TYPE_COMMON,
+			// A common callback fused with the one in the next instruction.
+			INSTRUCTION_TYPE_COMMON_PAIR,
 			INSTRUCTION_TYPE_CONDITIONAL,
+			INSTRUCTION_TYPE_LINK,
 		} type;
 	};
 
+	void ExecuteBlocks(bool follow_links);
+	void FuseInstructions(size_t start);
+	void WriteExit(u32 destination);
+
 	const u8* GetCodePtr() { return (u8*)(m_code.data() + m_code.size()); }
 
 	std::vector<Instruction> m_code;
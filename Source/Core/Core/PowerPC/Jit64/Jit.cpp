@@ -461,6 +461,21 @@ void Jit64::WriteBLRExit()
 	RET();
 }
 
+void Jit64::WriteIdleExit(u32 destination)
+{
+	// The analyst found that this branch closes a loop which only waits for something
+	// outside of it to change, which can't happen before the next event. CoreTiming::Idle
+	// zeroes the downcount, so the exit goes straight to doTiming.
+	js.curBlock->idleLoop = true;
+	if (CPU::GetState() != CPU::CPU_STEPPING)
+	{
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunction(reinterpret_cast<void *>(&CoreTiming::Idle));
+		ABI_PopRegistersAndAdjustStack({}, 0);
+	}
+	WriteExit(destination);
+}
+
 void Jit64::WriteRfiExitDestInRSCRATCH()
 {
 	MOV(32, PPCSTATE(pc), R(RSCRATCH));
@@ -93,6 +93,7 @@ public:
 	void JustWriteExit(u32 destination, bool bl, u32 after);
 	void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
 	void WriteBLRExit();
+	void WriteIdleExit(u32 destination);
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
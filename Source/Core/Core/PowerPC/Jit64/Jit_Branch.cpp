@@ -88,15 +88,10 @@ void Jit64::bx(UGeckoInstruction inst)
 	if (inst.LK)
 		AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
 #endif
-	if (destination == js.compilerPC)
-	{
-		//PanicAlert("Idle loop detected at %08x", destination);
-		// CALL(ProtectFunction(&CoreTiming::Idle, 0));
-		// JMP(Asm::testExceptions, true);
-		// make idle loops go faster
-		js.downcountAmount += 8;
-	}
-	WriteExit(destination, inst.LK, js.compilerPC + 4);
+	if (js.op->branchIsIdleLoop)
+		WriteIdleExit(destination);
+	else
+		WriteExit(destination, inst.LK, js.compilerPC + 4);
 }
 
 // TODO - optimize to hell and beyond
@@ -137,7 +132,10 @@ void Jit64::bcx(UGeckoInstruction inst)
 
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteExit(destination, inst.LK, js.compilerPC + 4);
+	if (js.op->branchIsIdleLoop)
+		WriteIdleExit(destination);
+	else
+		WriteExit(destination, inst.LK, js.compilerPC + 4);
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget(pConditionDontBranch);
@@ -11,8 +11,6 @@
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
 #include "Core/ConfigManager.h"
-#include "Core/CoreTiming.h"
-#include "Core/HW/CPU.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
@@ -113,53 +111,6 @@ void Jit64::lXXx(UGeckoInstruction inst)
 		signExtend = true;
 	}
 
-	// TODO(ector): Make it dynamically enable/disable idle skipping where appropriate
-	// Will give nice boost to dual core mode
-	// (mb2): I agree,
-	// IMHO those Idles should always be skipped and replaced by a more controllable "native" Idle methode
-	// ... maybe the throttle one already do that :p
-	// TODO: We shouldn't use a debug read here.  It should be possible to get
-	// the following instructions out of the JIT state.
-	if (CPU::GetState() != CPU::CPU_STEPPING &&
-		inst.OPCD == 32 &&
-		MergeAllowedNextInstructions(2) &&
-		(inst.hex & 0xFFFF0000) == 0x800D0000 &&
-		(js.op[1].inst.hex == 0x28000000 ||
-		(SConfig::GetInstance().bWii && js.op[1].inst.hex == 0x2C000000)) &&
-		js.op[2].inst.hex == 0x4182fff8)
-	{
-		// TODO(LinesPrower):
-		// - Rewrite this!
-		// It seems to be ugly and inefficient, but I don't know JIT stuff enough to make it right
-		// It only demonstrates the idea
-
-		// do our job at first
-		s32 offset = (s32)(s16)inst.SIMM_16;
-		gpr.BindToRegister(a, true, false);
-		gpr.BindToRegister(d, false, true);
-		SafeLoadToReg(gpr.RX(d), gpr.R(a), accessSize, offset, CallerSavedRegistersInUse(), signExtend);
-
-		// if it's still 0, we can wait until the next event
-		TEST(32, gpr.R(d), gpr.R(d));
-		FixupBranch noIdle = J_CC(CC_NZ);
-
-		BitSet32 registersInUse = CallerSavedRegistersInUse();
-		ABI_PushRegistersAndAdjustStack(registersInUse, 0);
-
-		ABI_CallFunction((void *)&CoreTiming::Idle);
-
-		ABI_PopRegistersAndAdjustStack(registersInUse, 0);
-
-		// ! we must continue executing of the loop after exception handling, maybe there is still 0 in r0
-		//MOV(32, PPCSTATE(pc), Imm32(js.compilerPC));
-		WriteExceptionExit();
-
-		SetJumpTarget(noIdle);
-
-		//js.compilerPC += 8;
-		return;
-	}
-
 	// Determine whether this instruction updates inst.RA
 	bool update;
 	if (inst.OPCD == 31)
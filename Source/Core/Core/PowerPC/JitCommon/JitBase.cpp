@@ -16,12 +16,14 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
 
 JitBase *jit;
 
 void Jit(u32 em_address)
 {
 	jit->Jit(em_address);
+	JitPersistentCache::BlockCompiled(em_address);
 }
 
 u32 Helper_Mask(u8 mb, u8 me)
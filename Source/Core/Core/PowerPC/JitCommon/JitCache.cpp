@@ -103,6 +103,7 @@ int JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
 	JitBlock &b = blocks[num_blocks];
 	b.invalid = false;
+	b.idleLoop = false;
 	b.originalAddress = em_address;
 	b.linkData.clear();
 	num_blocks++; //commit the current block
@@ -34,6 +34,7 @@ struct JitBlock
 	int runCount;  // for profiling.
 
 	bool invalid;
+	bool idleLoop;  // for profiling.
 
 	struct LinkData
 	{
@@ -0,0 +1,238 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace JitPersistentCache
+{
+static const u32 FILE_MAGIC = 0x314C424A;  // "JBL1"
+// Bump when the analyzer changes where blocks start or end.
+static const u32 FILE_VERSION = 1;
+// Half of the block cache, so that a batch leaves room for the blocks compiled on demand, and
+// doesn't fill the code space.
+static const size_t MAX_BLOCKS = 0x10000;
+
+struct Header
+{
+	u32 magic;
+	u32 version;
+	u32 core;
+	u32 count;
+};
+
+struct Entry
+{
+	u32 address;
+	u32 size;  // In instructions
+	u64 hash;
+};
+
+static bool s_enabled = false;
+static bool s_precompiling = false;
+static int s_core;
+static std::string s_path;
+
+// Blocks from the file which weren't compiled in this boot yet.
+static std::unordered_multimap<u32, Entry> s_pending;
+// Blocks compiled in this boot, by address and hash.
+static std::map<std::pair<u32, u64>, u32> s_compiled;
+
+static bool HashBlock(u32 address, u32 size, Entry* entry)
+{
+	// Like the block cache's invalidation, this takes the block's code as one range.
+	const u32 length = size * 4;
+	if (size == 0 || !PowerPC::HostIsRAMAddress(address) ||
+		!PowerPC::HostIsRAMAddress(address + length - 1))
+	{
+		return false;
+	}
+	const u8* code = Memory::GetPointer(address);
+	if (!code || Memory::GetPointer(address + length - 1) != code + length - 1)
+		return false;
+
+	entry->address = address;
+	entry->size = size;
+	entry->hash = GetMurmurHash3(code, length, 0);
+	return true;
+}
+
+static bool RecordBlock(u32 address, Entry* entry)
+{
+	JitBaseBlockCache* blocks = jit->GetBlockCache();
+	const int block_num = blocks->GetBlockNumberFromStartAddress(address);
+	if (block_num < 0 || !HashBlock(address, blocks->GetBlock(block_num)->originalSize, entry))
+		return false;
+
+	s_compiled[std::make_pair(entry->address, entry->hash)] = entry->size;
+	return true;
+}
+
+// Returns true if the block was pending.
+static bool RemovePending(const Entry& entry)
+{
+	const auto range = s_pending.equal_range(entry.address);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second.hash == entry.hash && it->second.size == entry.size)
+		{
+			s_pending.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void Precompile()
+{
+	JitBaseBlockCache* blocks = jit->GetBlockCache();
+
+	// Compiling reads the code through the emulated instruction cache. It is bypassed here, so
+	// that precompiling doesn't fill lines the game hasn't run yet. The lines a compile on demand
+	// would have filled stay empty too, though, so the icache still differs from a boot without
+	// the file.
+	const u32 hid0 = PowerPC::ppcState.spr[SPR_HID0];
+	HID0.ICE = 0;
+	s_precompiling = true;
+
+	u32 count = 0;
+	for (auto it = s_pending.begin(); it != s_pending.end();)
+	{
+		Entry entry;
+		if (!HashBlock(it->second.address, it->second.size, &entry) || entry.hash != it->second.hash)
+		{
+			++it;
+			continue;
+		}
+
+		if (blocks->GetBlockNumberFromStartAddress(entry.address) < 0)
+		{
+			if (static_cast<size_t>(blocks->GetNumBlocks()) >= MAX_BLOCKS)
+				break;
+
+			const int num_blocks = blocks->GetNumBlocks();
+			jit->Jit(entry.address);
+			// The code space filled up and the cache was cleared, taking the game's working set
+			// with it. Any later batch would do the same, so stop for this boot.
+			if (blocks->GetNumBlocks() <= num_blocks)
+			{
+				WARN_LOG(DYNA_REC, "JIT cache full, no more precompiling");
+				s_pending.clear();
+				break;
+			}
+			RecordBlock(entry.address, &entry);
+			count++;
+		}
+		it = s_pending.erase(it);
+	}
+
+	s_precompiling = false;
+	PowerPC::ppcState.spr[SPR_HID0] = hid0;
+
+	INFO_LOG(DYNA_REC, "Precompiled %u blocks, %zu left", count, s_pending.size());
+}
+
+void Init(int core)
+{
+	const SConfig& config = SConfig::GetInstance();
+
+	s_pending.clear();
+	s_compiled.clear();
+	// Blocks depend on breakpoints with debugging, and on the page table with the MMU.
+	// Precompiled blocks leave the emulated icache in another state than compiling on demand,
+	// which must not depend on a local file with netplay or movies.
+	s_enabled = config.bPersistentJITCache && !config.bEnableDebugging && !config.bMMU &&
+		!config.bJITNoBlockCache && !config.GetGameID().empty() &&
+		!NetPlay::IsNetPlayRunning() && !Movie::IsMovieActive();
+	if (!s_enabled)
+		return;
+
+	s_core = core;
+	s_path = File::GetUserPath(D_CACHE_IDX) + JITCACHE_DIR DIR_SEP +
+		StringFromFormat("%s-%d.bin", config.GetGameID().c_str(), core);
+
+	File::IOFile file(s_path, "rb");
+	Header header;
+	if (!file.ReadArray(&header, 1) || header.magic != FILE_MAGIC ||
+		header.version != FILE_VERSION || header.core != static_cast<u32>(core) ||
+		header.count > MAX_BLOCKS)
+	{
+		return;
+	}
+
+	std::vector<Entry> entries(header.count);
+	if (!file.ReadArray(entries.data(), entries.size()))
+	{
+		WARN_LOG(DYNA_REC, "Truncated JIT cache %s", s_path.c_str());
+		return;
+	}
+	for (const Entry& entry : entries)
+		s_pending.emplace(entry.address, entry);
+
+	INFO_LOG(DYNA_REC, "Loaded %zu blocks from %s", entries.size(), s_path.c_str());
+}
+
+void Shutdown()
+{
+	if (!s_enabled)
+		return;
+	s_enabled = false;
+
+	// Blocks compiled in this boot go first, then the ones which may still be used later on.
+	std::vector<Entry> entries;
+	entries.reserve(s_compiled.size() + s_pending.size());
+	for (const auto& compiled : s_compiled)
+		entries.push_back({ compiled.first.first, compiled.second, compiled.first.second });
+	for (const auto& pending : s_pending)
+	{
+		if (!s_compiled.count(std::make_pair(pending.second.address, pending.second.hash)))
+			entries.push_back(pending.second);
+	}
+	if (entries.size() > MAX_BLOCKS)
+		entries.resize(MAX_BLOCKS);
+	s_pending.clear();
+	s_compiled.clear();
+
+	if (entries.empty())
+		return;
+
+	File::CreateFullPath(s_path);
+	File::IOFile file(s_path, "wb");
+	const Header header = { FILE_MAGIC, FILE_VERSION, static_cast<u32>(s_core),
+		static_cast<u32>(entries.size()) };
+	if (!file.WriteArray(&header, 1) || !file.WriteArray(entries.data(), entries.size()))
+		ERROR_LOG(DYNA_REC, "Failed to write JIT cache %s", s_path.c_str());
+}
+
+void BlockCompiled(u32 address)
+{
+	if (!s_enabled || s_precompiling)
+		return;
+
+	Entry entry;
+	if (!RecordBlock(address, &entry))
+		return;
+
+	// Code seen in an earlier boot was loaded, the rest of it is likely there too.
+	if (RemovePending(entry))
+		Precompile();
+}
+}
@@ -0,0 +1,30 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// The persistent JIT cache remembers which blocks a game ran in earlier boots, so that they
+// are compiled in one go as soon as their code is in RAM, rather than one at a time while
+// the game first runs them.
+//
+// With Core/PersistentJITCache enabled, every block compiled on demand is recorded with its
+// address, length and a hash of its code. The records are saved in the Cache directory on
+// shutdown, one file per game ID and CPU core. When a recorded block whose code still
+// matches is compiled on demand, every other recorded block matching RAM is compiled too.
+// Precompiled blocks are ordinary blocks, so writes to their code invalidate them as usual.
+// They are read around the emulated instruction cache, which is left without the lines a
+// compile on demand would have filled, so this is off with netplay and movies.
+//
+// Only the records are stored, not the host code: the JITs' code calls and jumps to
+// absolute addresses and is patched in place, so it can't be used by another process.
+namespace JitPersistentCache
+{
+void Init(int core);
+void Shutdown();
+
+// Called on the CPU thread after the JIT compiled the block at address on demand.
+void BlockCompiled(u32 address);
+}
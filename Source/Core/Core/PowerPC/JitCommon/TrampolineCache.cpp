@@ -64,6 +64,49 @@ const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, B
 	else if (info.displacement)
 		ADD(32, R(ABI_PARAM1), Imm32(info.displacement));
 
+	// Loads that fault here mostly go through the page table, so try the host TLB before paying
+	// for the call and the register spills.
+	FixupBranch host_tlb_hit;
+	const s64 tag_disp = (char*)&PowerPC::host_tlb.tag[PowerPC::HOST_TLB_READ] - (char*)&PowerPC::ppcState - 0x80;
+	const s64 offset_disp = (char*)&PowerPC::host_tlb.offset[PowerPC::HOST_TLB_READ] - (char*)&PowerPC::ppcState - 0x80;
+	const bool probe_host_tlb = tag_disp == (s32)tag_disp && offset_disp == (s32)offset_disp;
+	if (probe_host_tlb)
+	{
+		const bool push_scratch2 = registersInUse[RSCRATCH2];
+		TEST(32, PPCSTATE(msr), Imm32(1 << 4));  // MSR.DR
+		FixupBranch untranslated = J_CC(CC_Z);
+		// The host TLB only maps the first page. A load crossing into the next one has to
+		// translate that page too (and may raise a DSI there), so it takes the call, like in
+		// ReadFromHardware.
+		FixupBranch crosses_page;
+		if (info.operandSize > 1)
+		{
+			MOV(32, R(RSCRATCH), R(ABI_PARAM1));
+			AND(32, R(RSCRATCH), Imm32((1 << HW_PAGE_INDEX_SHIFT) - 1));
+			CMP(32, R(RSCRATCH), Imm32((1 << HW_PAGE_INDEX_SHIFT) - info.operandSize));
+			crosses_page = J_CC(CC_A);
+		}
+		if (push_scratch2)
+			PUSH(RSCRATCH2);
+		MOV(32, R(RSCRATCH), R(ABI_PARAM1));
+		SHR(32, R(RSCRATCH), Imm8(HW_PAGE_INDEX_SHIFT));
+		MOV(32, R(RSCRATCH2), R(RSCRATCH));
+		AND(32, R(RSCRATCH2), Imm8(HW_PAGE_INDEX_MASK));
+		CMP(32, R(RSCRATCH), MComplex(RPPCSTATE, RSCRATCH2, SCALE_4, (s32)tag_disp));
+		FixupBranch miss = J_CC(CC_NE);
+		MOV(64, R(RSCRATCH), MComplex(RPPCSTATE, RSCRATCH2, SCALE_8, (s32)offset_disp));
+		if (push_scratch2)
+			POP(RSCRATCH2);
+		LoadAndSwap(info.operandSize * 8, ABI_RETURN, MRegSum(RSCRATCH, ABI_PARAM1));
+		host_tlb_hit = J();
+		SetJumpTarget(miss);
+		if (push_scratch2)
+			POP(RSCRATCH2);
+		SetJumpTarget(untranslated);
+		if (info.operandSize > 1)
+			SetJumpTarget(crosses_page);
+	}
+
 	ABI_PushRegistersAndAdjustStack(registersInUse, stack_offset);
 
 	switch (info.operandSize)
@@ -84,6 +127,9 @@ const u8* TrampolineCache::GenerateReadTrampoline(const InstructionInfo &info, B
 
 	ABI_PopRegistersAndAdjustStack(registersInUse, stack_offset);
 
+	if (probe_host_tlb)
+		SetJumpTarget(host_tlb_hit);
+
 	if (push_param1)
 		POP(ABI_PARAM1);
 
@@ -14,12 +14,14 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/CoreTiming.h"
 #include "Core/PowerPC/CachedInterpreter.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/Profiler.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitPersistentCache.h"
 
 #if _M_X86
 #include "Core/PowerPC/Jit64/Jit.h"
@@ -73,6 +75,7 @@ CPUCoreBase *InitJitCore(int core)
 	}
 	jit = static_cast<JitBase*>(ptr);
 	jit->Init();
+	JitPersistentCache::Init(core);
 	return ptr;
 }
 void InitTables(int core)
@@ -127,6 +130,9 @@ void WriteProfileResults(const std::string& filename)
 			stat.tick_counter, percent, timePercent,
 			(double)stat.tick_counter*1000.0 / (double)prof_stats.countsPerSec, stat.block_size);
 	}
+	fprintf(f.GetHandle(), "\nidleLoopBlocks\tidleCount\tidleTicks\n");
+	fprintf(f.GetHandle(), "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n", prof_stats.idle_loop_blocks,
+		prof_stats.idle_count, prof_stats.idle_ticks);
 }
 
 void GetProfileResults(ProfileStats* prof_stats)
@@ -137,6 +143,7 @@ void GetProfileResults(ProfileStats* prof_stats)
 
 	prof_stats->cost_sum = 0;
 	prof_stats->timecost_sum = 0;
+	prof_stats->idle_loop_blocks = 0;
 	prof_stats->block_stats.clear();
 	prof_stats->block_stats.reserve(jit->GetBlockCache()->GetNumBlocks());
 
@@ -158,7 +165,11 @@ void GetProfileResults(ProfileStats* prof_stats)
 				block->runCount, block->codeSize);
 		prof_stats->cost_sum += cost;
 		prof_stats->timecost_sum += timecost;
+		if (block->idleLoop && !block->invalid)
+			prof_stats->idle_loop_blocks++;
 	}
+	prof_stats->idle_count = CoreTiming::GetIdleCount();
+	prof_stats->idle_ticks = CoreTiming::GetIdleTicks();
 
 	sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
 	if (old_state == Core::CORE_RUN)
@@ -286,6 +297,7 @@ void Shutdown()
 {
 	if (jit)
 	{
+		JitPersistentCache::Shutdown();
 		jit->Shutdown();
 		delete jit;
 		jit = nullptr;
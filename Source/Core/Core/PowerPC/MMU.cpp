@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <unordered_map>
 
 #include "Common/Atomic.h"
@@ -67,6 +70,20 @@ enum XCheckTLBFlag
 };
 template <const XCheckTLBFlag flag> static u32 TranslateAddress(const u32 address);
 
+HostTLB host_tlb;
+
+// Returns the host address of em_address if the host TLB has its page, or null.
+template <const XCheckTLBFlag flag>
+__forceinline static u8* LookupHostTLB(const u32 em_address)
+{
+	const int type = flag == FLAG_WRITE ? HOST_TLB_WRITE : HOST_TLB_READ;
+	const u32 tag = em_address >> HW_PAGE_INDEX_SHIFT;
+	const u32 set = tag & HW_PAGE_INDEX_MASK;
+	if (host_tlb.tag[type][set] != tag)
+		return nullptr;
+	return reinterpret_cast<u8*>(host_tlb.offset[type][set] + em_address);
+}
+
 // Nasty but necessary. Super Mario Galaxy pointer relies on this stuff.
 static u32 EFB_Read(const u32 addr)
 {
@@ -188,6 +205,16 @@ __forceinline static T ReadFromHardware(const u32 em_address)
 	}
 
 	// MMU: Do page table translation
+	// The alignment check isn't strictly necessary, but it provides a faster (1 instruction on x86)
+	// bailout for the common case.
+	const bool crosses_page = sizeof(T) > 1 && (em_address & (sizeof(T) - 1)) &&
+		(em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T);
+	if (flag != FLAG_NO_EXCEPTION && !crosses_page)
+	{
+		if (const u8* host_address = LookupHostTLB<flag>(em_address))
+			return bswap(*(const T*)host_address);
+	}
+
 	u32 tlb_addr = TranslateAddress<flag>(em_address);
 	if (tlb_addr == 0)
 	{
@@ -197,30 +224,24 @@ __forceinline static T ReadFromHardware(const u32 em_address)
 	}
 
 	// Handle loads that cross page boundaries (ewwww)
-	// The alignment check isn't strictly necessary, but since this is a rare slow path, it provides a faster
-	// (1 instruction on x86) bailout.
-	if (sizeof(T) > 1 && (em_address & (sizeof(T) - 1)) && (em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T))
+	if (crosses_page)
 	{
-		// This could be unaligned down to the byte level... hopefully this is rare, so doing it this
-		// way isn't too terrible.
 		// TODO: floats on non-word-aligned boundaries should technically cause alignment exceptions.
 		// Note that "word" means 32-bit, so paired singles or doubles might still be 32-bit aligned!
 		u32 em_address_next_page = (em_address + sizeof(T) - 1) & ~(HW_PAGE_SIZE - 1);
 		u32 tlb_addr_next_page = TranslateAddress<flag>(em_address_next_page);
-		if (tlb_addr == 0 || tlb_addr_next_page == 0)
+		if (tlb_addr_next_page == 0)
 		{
 			if (flag == FLAG_READ)
 				GenerateDSIException(em_address_next_page, false);
 			return 0;
 		}
-		T var = 0;
-		for (u32 addr = em_address; addr < em_address + sizeof(T); addr++, tlb_addr++)
-		{
-			if (addr == em_address_next_page)
-				tlb_addr = tlb_addr_next_page;
-			var = (var << 8) | Memory::physical_base[tlb_addr];
-		}
-		return var;
+		const u32 first_size = em_address_next_page - em_address;
+		T var;
+		memcpy(&var, &Memory::physical_base[tlb_addr], first_size);
+		memcpy(reinterpret_cast<u8*>(&var) + first_size, &Memory::physical_base[tlb_addr_next_page],
+			sizeof(T) - first_size);
+		return bswap(var);
 	}
 
 	// The easy case!
@@ -339,6 +360,17 @@ __forceinline static void WriteToHardware(u32 em_address, const T data)
 	}
 
 	// MMU: Do page table translation
+	const bool crosses_page = sizeof(T) > 1 && (em_address & (sizeof(T) - 1)) &&
+		(em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T);
+	if (flag != FLAG_NO_EXCEPTION && !crosses_page)
+	{
+		if (u8* host_address = LookupHostTLB<flag>(em_address))
+		{
+			*(T*)host_address = bswap(data);
+			return;
+		}
+	}
+
 	u32 tlb_addr = TranslateAddress<flag>(em_address);
 	if (tlb_addr == 0)
 	{
@@ -348,9 +380,9 @@ __forceinline static void WriteToHardware(u32 em_address, const T data)
 	}
 
 	// Handle stores that cross page boundaries (ewwww)
-	if (sizeof(T) > 1 && (em_address & (sizeof(T) - 1)) && (em_address & (HW_PAGE_SIZE - 1)) > HW_PAGE_SIZE - sizeof(T))
+	if (crosses_page)
 	{
-		T val = bswap(data);
+		const T val = bswap(data);
 
 		// We need to check both addresses before writing in case there's a DSI.
 		u32 em_address_next_page = (em_address + sizeof(T) - 1) & ~(HW_PAGE_SIZE - 1);
@@ -361,12 +393,10 @@ __forceinline static void WriteToHardware(u32 em_address, const T data)
 				GenerateDSIException(em_address_next_page, true);
 			return;
 		}
-		for (u32 addr = em_address; addr < em_address + sizeof(T); addr++, tlb_addr++, val >>= 8)
-		{
-			if (addr == em_address_next_page)
-				tlb_addr = tlb_addr_next_page;
-			Memory::physical_base[tlb_addr] = (u8)val;
-		}
+		const u32 first_size = em_address_next_page - em_address;
+		memcpy(&Memory::physical_base[tlb_addr], &val, first_size);
+		memcpy(&Memory::physical_base[tlb_addr_next_page], reinterpret_cast<const u8*>(&val) + first_size,
+			sizeof(T) - first_size);
 		return;
 	}
 
@@ -1209,6 +1239,7 @@ void SDRUpdated()
 	}
 	PowerPC::ppcState.pagetable_base = htaborg << 16;
 	PowerPC::ppcState.pagetable_hashmask = ((xx << 10) | 0x3ff);
+	InvalidateHostTLB();
 }
 
 enum TLBLookupResult
@@ -1291,6 +1322,41 @@ void InvalidateTLBEntry(u32 address)
 	PowerPC::tlb_entry *tlbe_i = &PowerPC::ppcState.tlb[1][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
 	tlbe_i->tag[0] = TLB_TAG_INVALID;
 	tlbe_i->tag[1] = TLB_TAG_INVALID;
+
+	for (auto& tags : host_tlb.tag)
+		tags[(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK] = TLB_TAG_INVALID;
+}
+
+// The TLB doesn't look at the segment registers or the BATs, but translations made with old
+// ones shouldn't outlive them once it does, so changing them also drops the host TLB.
+void InvalidateHostTLB()
+{
+	for (auto& tags : host_tlb.tag)
+		std::fill(std::begin(tags), std::end(tags), TLB_TAG_INVALID);
+}
+
+// Called after a lookup of address went through the TLB. If its page is now the most recently
+// used one of its set, the host TLB takes it over.
+static __forceinline void UpdateHostTLB(const XCheckTLBFlag flag, const u32 address)
+{
+	if (flag != FLAG_READ && flag != FLAG_WRITE)
+		return;
+
+	const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+	const u32 set = tag & HW_PAGE_INDEX_MASK;
+	const PowerPC::tlb_entry& tlbe = PowerPC::ppcState.tlb[0][set];
+	const int way = tlbe.recent;
+	if (tlbe.tag[way] != tag)
+		return;
+
+	UPTE2 PTE2;
+	PTE2.Hex = tlbe.pte[way];
+	const uintptr_t offset = reinterpret_cast<uintptr_t>(Memory::physical_base) + tlbe.paddr[way] -
+		(tag << HW_PAGE_INDEX_SHIFT);
+	host_tlb.tag[HOST_TLB_READ][set] = tag;
+	host_tlb.offset[HOST_TLB_READ][set] = offset;
+	host_tlb.tag[HOST_TLB_WRITE][set] = PTE2.C ? tag : TLB_TAG_INVALID;
+	host_tlb.offset[HOST_TLB_WRITE][set] = offset;
 }
 
 // Page Address Translation
@@ -1302,7 +1368,10 @@ static __forceinline u32 TranslatePageAddress(const u32 address, const XCheckTLB
 	u32 translatedAddress = 0;
 	TLBLookupResult res = LookupTLBPageAddress(flag, address, &translatedAddress);
 	if (res == TLB_FOUND)
+	{
+		UpdateHostTLB(flag, address);
 		return translatedAddress;
+	}
 
 	u32 sr = PowerPC::ppcState.sr[EA_SR(address)];
 
@@ -1348,6 +1417,7 @@ static __forceinline u32 TranslatePageAddress(const u32 address, const XCheckTLB
 				// We already updated the TLB entry if this was caused by a C bit.
 				if (res != TLB_UPDATE_C)
 					UpdateTLBEntry(flag, PTE2, address);
+				UpdateHostTLB(flag, address);
 
 				return (PTE2.RPN << 12) | offset;
 			}
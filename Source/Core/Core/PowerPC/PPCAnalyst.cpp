@@ -622,6 +622,45 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	}
 }
 
+bool PPCAnalyzer::IsBusyWaitLoop(const CodeOp *code, u32 branch_index) const
+{
+	// A loop is only waiting if an iteration can't change anything the next one sees: it
+	// may only load, compute and compare, and every register (or carry) it reads must
+	// either be left alone or be written earlier in the same iteration. Then it will keep
+	// branching back until memory changes, which only an event or an exception can do.
+	// Loops reading the time base or any other SPR are not simple integer ops, so they
+	// are never skipped.
+	const CodeOp& branch = code[branch_index];
+	if (branch.inst.LK)
+		return false;
+	if (branch.inst.OPCD == 16 && (branch.inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+		return false;
+
+	BitSet32 written, read_first;
+	bool ca_written = false, ca_read_first = false;
+	for (u32 i = 0; i < branch_index; i++)
+	{
+		const GekkoOPInfo* opinfo = code[i].opinfo;
+		if (opinfo->type != OPTYPE_INTEGER && opinfo->type != OPTYPE_LOAD)
+			return false;
+
+		read_first |= code[i].regsIn & ~written;
+		if (code[i].regsOut & read_first)
+			return false;
+		written |= code[i].regsOut;
+
+		if ((opinfo->flags & FL_READ_CA) && !ca_written)
+			ca_read_first = true;
+		if (opinfo->flags & FL_SET_CA)
+		{
+			if (ca_read_first)
+				return false;
+			ca_written = true;
+		}
+	}
+	return true;
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -686,6 +725,17 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 		SetInstructionStats(block, &code[i], opinfo, i);
 
+		if (inst.OPCD == 16 || inst.OPCD == 18)
+		{
+			u32 target;
+			if (inst.OPCD == 16)
+				target = (inst.AA ? 0 : address) + SignExt16(inst.BD << 2);
+			else
+				target = (inst.AA ? 0 : address) + SignExt26(inst.LI << 2);
+			code[i].branchTo = target;
+			code[i].branchIsIdleLoop = target == block->m_address && IsBusyWaitLoop(code, i);
+		}
+
 		bool follow = false;
 		u32 destination = 0;
 
@@ -25,7 +25,7 @@ struct CodeOp //16B
 	UGeckoInstruction inst;
 	GekkoOPInfo * opinfo;
 	u32 address;
-	u32 branchTo; //if 0, not a branch
+	u32 branchTo; //destination of b and bc, -1 for other instructions
 	int branchToIndex; //index of target block
 	BitSet32 regsOut;
 	BitSet32 regsIn;
@@ -43,6 +43,9 @@ struct CodeOp //16B
 	bool outputCA;
 	bool canEndBlock;
 	bool skip;  // followed BL-s for example
+	// This branch closes a loop which can't leave until something outside of it changes
+	// memory, so the time until the next event can be skipped whenever it's taken.
+	bool branchIsIdleLoop;
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
@@ -180,6 +183,7 @@ private:
 	void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
 	void ReorderInstructions(u32 instructions, CodeOp *code);
 	void SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index);
+	bool IsBusyWaitLoop(const CodeOp *code, u32 branch_index) const;
 
 	// Options
 	u32 m_options;
@@ -65,6 +65,8 @@ void DoState(PointerWrap &p)
 	// *((u64 *)&TL) = SystemTimers::GetFakeTimeBase(); //works since we are little endian and TL comes first :)
 
 	p.DoPOD(ppcState);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		InvalidateHostTLB();
 
 	// SystemTimers::DecrementerSet();
 	// SystemTimers::TimeBaseSet();
@@ -133,6 +135,7 @@ void Init(int cpu_core)
 			}
 		}
 	}
+	InvalidateHostTLB();
 
 	ResetRegisters();
 	PPCTables::InitTables(cpu_core);
@@ -129,6 +129,26 @@ static_assert(offsetof(PowerPC::PowerPCState, above_fits_in_first_0x100) <= 0x10
 
 extern PowerPCState ppcState;
 
+// A host-side cache in front of the TLB for loads and stores that go through the page
+// table. Entry i holds the most recently used way of TLB set i, so a hit leaves the TLB
+// exactly as a full lookup would and the two can't disagree. Stores only use pages whose
+// C bit is already set. This isn't emulated state, so it isn't saved in savestates.
+enum HostTLBType
+{
+	HOST_TLB_READ,
+	HOST_TLB_WRITE,
+	NUM_HOST_TLBS
+};
+
+struct HostTLB
+{
+	u32 tag[NUM_HOST_TLBS][TLB_SIZE / TLB_WAYS];
+	// Host address of the page minus its effective address.
+	uintptr_t offset[NUM_HOST_TLBS][TLB_SIZE / TLB_WAYS];
+};
+
+extern HostTLB host_tlb;
+
 extern Watches watches;
 extern BreakPoints breakpoints;
 extern MemChecks memchecks;
@@ -263,6 +283,7 @@ void ClearCacheLine(const u32 address); // Zeroes 32 bytes; address should be 32
 // TLB functions
 void SDRUpdated();
 void InvalidateTLBEntry(u32 address);
+void InvalidateHostTLB();
 
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
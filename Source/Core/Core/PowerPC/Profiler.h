@@ -64,6 +64,11 @@ struct ProfileStats
 	u64 cost_sum;
 	u64 timecost_sum;
 	u64 countsPerSec;
+	// Idle loop skipping: how many compiled blocks are idle loops, how many times the CPU
+	// skipped ahead to the next event, and how many ticks that saved.
+	u64 idle_loop_blocks;
+	u64 idle_count;
+	u64 idle_ticks;
 };
 
 namespace Profiler
@@ -0,0 +1,312 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
+#include "Core/Rewind.h"
+#include "Core/Slippi/SlippiNetplay.h"
+#include "Core/State.h"
+
+namespace Rewind
+{
+struct Entry
+{
+	u64 frame;
+	size_t size;  // Of the state
+	bool keyframe;
+	std::vector<u8> delta;
+};
+
+static std::mutex s_mutex;
+static std::deque<Entry> s_entries;
+static size_t s_memory_used;   // By the deltas
+static u32 s_deltas_since_keyframe;
+
+// The state of s_entries.back(), to encode the next capture against.
+static std::vector<u8> s_newest;
+// Reused for every capture and restore, so they don't allocate.
+static std::vector<u8> s_scratch;
+static std::vector<u8> s_delta;
+
+static bool s_enabled = false;
+static u32 s_interval;
+static size_t s_memory_budget;
+
+static u32 s_frames_since_capture;  // GPU thread
+static std::atomic<bool> s_capture_pending;
+
+static u64 ReadWord(const u8* data, size_t pos)
+{
+	u64 word = 0;
+	if (data)
+		std::memcpy(&word, data + pos, sizeof(word));
+	return word;
+}
+
+void EncodeDelta(const u8* base, const u8* state, size_t size, std::vector<u8>* out)
+{
+	out->clear();
+
+	// Runs are found a word at a time, the bytes after the last whole word one at a time.
+	const size_t word_end = size & ~size_t(7);
+	size_t pos = 0;
+	while (pos < size)
+	{
+		const size_t skip_start = pos;
+		while (pos < word_end && ReadWord(base, pos) == ReadWord(state, pos))
+			pos += 8;
+		if (pos >= word_end)
+		{
+			while (pos < size && (base ? base[pos] : 0) == state[pos])
+				++pos;
+		}
+		if (pos == size)
+			break;
+
+		const size_t literal_start = pos;
+		while (pos < word_end && ReadWord(base, pos) != ReadWord(state, pos))
+			pos += 8;
+		if (pos >= word_end)
+			pos = size;
+
+		const u32 run[2] = {static_cast<u32>(literal_start - skip_start),
+			static_cast<u32>(pos - literal_start)};
+		const size_t offset = out->size();
+		out->resize(offset + sizeof(run) + run[1]);
+		u8* dest = out->data() + offset;
+		std::memcpy(dest, run, sizeof(run));
+		dest += sizeof(run);
+
+		if (base)
+		{
+			for (size_t i = literal_start; i < pos; ++i)
+				*dest++ = base[i] ^ state[i];
+		}
+		else
+		{
+			std::memcpy(dest, state + literal_start, run[1]);
+		}
+	}
+}
+
+bool ApplyDelta(const u8* delta, size_t delta_size, u8* state, size_t state_size)
+{
+	const u8* const end = delta + delta_size;
+	size_t pos = 0;
+	while (delta != end)
+	{
+		u32 run[2];
+		if (static_cast<size_t>(end - delta) < sizeof(run))
+			return false;
+		std::memcpy(run, delta, sizeof(run));
+		delta += sizeof(run);
+
+		if (run[1] > static_cast<size_t>(end - delta) || run[0] > state_size - pos ||
+			run[1] > state_size - pos - run[0])
+		{
+			return false;
+		}
+
+		pos += run[0];
+		for (u32 i = 0; i < run[1]; ++i)
+			state[pos + i] ^= delta[i];
+		pos += run[1];
+		delta += run[1];
+	}
+	return true;
+}
+
+static void Clear()
+{
+	s_entries.clear();
+	s_memory_used = 0;
+	s_deltas_since_keyframe = 0;
+}
+
+static void DropOldEntries()
+{
+	// Deltas are useless without the keyframe before them, so whole groups are dropped,
+	// and the newest group always stays.
+	while (s_memory_used > s_memory_budget)
+	{
+		const auto next_keyframe = std::find_if(s_entries.begin() + 1, s_entries.end(),
+			[](const Entry& entry) { return entry.keyframe; });
+		if (next_keyframe == s_entries.end())
+			break;
+
+		for (auto it = s_entries.begin(); it != next_keyframe; ++it)
+			s_memory_used -= it->delta.size();
+		s_entries.erase(s_entries.begin(), next_keyframe);
+	}
+}
+
+static void Capture()
+{
+	std::lock_guard<std::mutex> lk(s_mutex);
+	if (!s_enabled)
+		return;
+
+	const bool was_unpaused = Core::PauseAndLock(true);
+	const u64 frame = Movie::GetCurrentFrame();
+	State::SaveToBuffer(s_scratch);
+	Core::PauseAndLock(false, was_unpaused);
+
+	if (s_scratch.empty())
+		return;
+
+	// Something else (e.g. loading a savestate) took the emulation back in time, so the
+	// stored states belong to another timeline.
+	if (!s_entries.empty() && frame <= s_entries.back().frame)
+		Clear();
+
+	Entry entry;
+	entry.frame = frame;
+	entry.size = s_scratch.size();
+	entry.keyframe = s_entries.empty() || s_newest.size() != s_scratch.size() ||
+		s_deltas_since_keyframe + 1 >= KEYFRAME_INTERVAL;
+
+	EncodeDelta(entry.keyframe ? nullptr : s_newest.data(), s_scratch.data(), s_scratch.size(),
+		&s_delta);
+	entry.delta.assign(s_delta.begin(), s_delta.end());
+
+	s_deltas_since_keyframe = entry.keyframe ? 0 : s_deltas_since_keyframe + 1;
+	s_memory_used += entry.delta.size();
+	s_entries.push_back(std::move(entry));
+	std::swap(s_newest, s_scratch);
+
+	DropOldEntries();
+}
+
+void Init()
+{
+	const SConfig& config = SConfig::GetInstance();
+
+	std::lock_guard<std::mutex> lk(s_mutex);
+	Clear();
+	s_enabled = config.bRewind && !NetPlay::IsNetPlayRunning();
+	s_interval = std::max(1, config.iRewindInterval);
+	s_memory_budget = static_cast<size_t>(std::max(1, config.iRewindMemoryMB)) * 1024 * 1024;
+	s_frames_since_capture = 0;
+	s_capture_pending.store(false);
+
+	if (s_enabled)
+	{
+		INFO_LOG(COMMON, "Rewind: capturing every %u frames, keeping up to %zu MiB", s_interval,
+			s_memory_budget / (1024 * 1024));
+	}
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_mutex);
+	s_enabled = false;
+	Clear();
+	std::vector<u8>().swap(s_newest);
+	std::vector<u8>().swap(s_scratch);
+	std::vector<u8>().swap(s_delta);
+}
+
+void FrameUpdate()
+{
+	// Slippi online doesn't go through NetPlay and only connects once the game is running,
+	// so it's checked every frame. A capture pauses emulation, which would stall the match.
+	if (!s_enabled || IsOnline() || ++s_frames_since_capture < s_interval)
+		return;
+	s_frames_since_capture = 0;
+
+	// Skip captures while the host is still busy with the previous one.
+	if (s_capture_pending.exchange(true))
+		return;
+
+	Core::QueueHostJob([] {
+		Capture();
+		s_capture_pending.store(false);
+	});
+}
+
+bool LoadFrame(u64 frame)
+{
+	std::lock_guard<std::mutex> lk(s_mutex);
+
+	const auto it = std::upper_bound(s_entries.begin(), s_entries.end(), frame,
+		[](u64 value, const Entry& entry) { return value < entry.frame; });
+	if (it == s_entries.begin())
+		return false;
+
+	const size_t index = it - s_entries.begin() - 1;
+	const size_t newest = s_entries.size() - 1;
+	size_t keyframe = index;
+	while (!s_entries[keyframe].keyframe)
+		--keyframe;
+
+	std::vector<u8>* state = &s_newest;
+	if (index != newest)
+	{
+		// Deltas work both ways, so the state can also be rebuilt by undoing the newer deltas
+		// on the newest state, as long as there's no keyframe in the way.
+		const bool has_later_keyframe = std::any_of(s_entries.begin() + index + 1, s_entries.end(),
+			[](const Entry& entry) { return entry.keyframe; });
+		bool ok = true;
+		if (!has_later_keyframe && newest - index < index - keyframe + 1)
+		{
+			s_scratch.assign(s_newest.begin(), s_newest.end());
+			for (size_t i = newest; i > index && ok; --i)
+			{
+				const Entry& entry = s_entries[i];
+				ok = ApplyDelta(entry.delta.data(), entry.delta.size(), s_scratch.data(),
+					s_scratch.size());
+			}
+		}
+		else
+		{
+			s_scratch.assign(s_entries[keyframe].size, 0);
+			for (size_t i = keyframe; i <= index && ok; ++i)
+			{
+				const Entry& entry = s_entries[i];
+				ok = ApplyDelta(entry.delta.data(), entry.delta.size(), s_scratch.data(),
+					s_scratch.size());
+			}
+		}
+
+		if (!ok)
+		{
+			ERROR_LOG(COMMON, "Rewind: corrupted delta, dropping all states");
+			Clear();
+			return false;
+		}
+		state = &s_scratch;
+	}
+
+	if (!State::LoadFromBuffer(*state))
+		return false;
+
+	// Captures continue from the loaded state, so the states after it are gone.
+	for (size_t i = index + 1; i < s_entries.size(); ++i)
+		s_memory_used -= s_entries[i].delta.size();
+	s_entries.erase(s_entries.begin() + index + 1, s_entries.end());
+	s_deltas_since_keyframe = static_cast<u32>(index - keyframe);
+	if (state == &s_scratch)
+		std::swap(s_newest, s_scratch);
+
+	return true;
+}
+
+bool StepBack()
+{
+	const u64 frame = Movie::GetCurrentFrame();
+	return LoadFrame(frame > s_interval ? frame - s_interval : 0);
+}
+}
@@ -0,0 +1,44 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Rewind keeps recent savestates in memory so the emulation can be taken back a few
+// seconds at any time, whatever the game.
+//
+// With Core/Rewind enabled, a state is captured every Core/RewindInterval frames. Only
+// the first state of every group of KEYFRAME_INTERVAL captures (a keyframe) is stored
+// whole, the others are stored as the difference to the state captured before them.
+// When the states take more than Core/RewindMemoryMB, the oldest groups are dropped.
+namespace Rewind
+{
+static const u32 KEYFRAME_INTERVAL = 30;
+
+void Init();
+void Shutdown();
+
+// Called on the GPU thread whenever a frame is presented.
+void FrameUpdate();
+
+// Loads the newest state captured at or before frame, and forgets the states newer than
+// it. Host thread only.
+bool LoadFrame(u64 frame);
+
+// Takes the emulation back by at least Core/RewindInterval frames.
+bool StepBack();
+
+// A delta is a list of runs: a u32 count of unchanged bytes, a u32 count of changed
+// bytes, then the changed bytes XORed with the base. A null base reads as zeroes, which
+// is how keyframes are stored.
+void EncodeDelta(const u8* base, const u8* state, size_t size, std::vector<u8>* out);
+
+// Applies a delta to state in place, turning the base into the state or the state into
+// the base. Returns false if the delta doesn't fit in state_size bytes.
+bool ApplyDelta(const u8* delta, size_t delta_size, u8* state, size_t state_size);
+}
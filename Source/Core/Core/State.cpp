@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
@@ -9,6 +12,7 @@
 #include <thread>
 #include <utility>
 #include <vector>
+#include <zlib.h>
 #include <Core/Slippi/SlippiNetplay.h>
 
 #include "Common/ChunkFile.h"
@@ -39,22 +43,27 @@
 
 namespace State
 {
-#if defined(__LZO_STRICT_16BIT)
-static const u32 IN_LEN = 8 * 1024u;
-#elif defined(LZO_ARCH_I086) && !defined(LZO_HAVE_MM_HUGE_ARRAY)
-static const u32 IN_LEN = 60 * 1024u;
-#else
-static const u32 IN_LEN = 128 * 1024u;
-#endif
-
-static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
-
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
-
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+// Legacy states are a sequence of LZO compressed blocks of this size, each preceded by its
+// compressed size.
+static const u32 LEGACY_IN_LEN = 128 * 1024u;
+static const u32 LEGACY_OUT_LEN = LEGACY_IN_LEN + (LEGACY_IN_LEN / 16) + 64 + 3;
+
+// Newer states are split into chunks which are compressed independently, so they can be
+// compressed and decompressed on all cores. The compressed data starts with a
+// ChunkedStateHeader and a table of the compressed chunk sizes. The magic is larger than
+// any legacy block size, which tells the two formats apart.
+static const u32 CHUNKED_STATE_MAGIC = 0x4B4E4843;  // "CHNK"
+static const u32 STATE_CHUNK_SIZE = 1024 * 1024;
+// Set in the size of chunks which didn't compress and are stored as is.
+static const u32 STORED_CHUNK_FLAG = 0x80000000;
+
+struct ChunkedStateHeader
+{
+	u32 magic;
+	u32 codec;  // StateCodec
+	u32 chunk_size;
+	u32 chunk_count;
+};
 
 static std::string g_last_filename;
 
@@ -104,6 +113,162 @@ void EnableCompression(bool compression)
 	g_use_compression = compression;
 }
 
+// Calls func(worker, index) for every index in [0, count) from up to one thread per core.
+template <typename Func>
+static void ParallelFor(size_t count, size_t workers, Func func)
+{
+	std::atomic<size_t> next(0);
+	auto work = [&](size_t worker) {
+		for (size_t i = next++; i < count; i = next++)
+			func(worker, i);
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < workers; ++i)
+		threads.emplace_back(work, i);
+	work(0);
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+static size_t GetWorkerCount(size_t chunk_count)
+{
+	return std::max<size_t>(1, std::min<size_t>(chunk_count, std::thread::hardware_concurrency()));
+}
+
+static size_t GetChunkCount(size_t size)
+{
+	return (size + STATE_CHUNK_SIZE - 1) / STATE_CHUNK_SIZE;
+}
+
+// Appends the compressed state to out.
+static void CompressState(const u8* data, size_t size, StateCodec codec, int level,
+	std::vector<u8>* out)
+{
+	const size_t chunk_count = GetChunkCount(size);
+	const size_t workers = GetWorkerCount(chunk_count);
+
+	std::vector<std::vector<u8>> work_memory(workers);
+	std::vector<std::vector<u8>> chunks(chunk_count);
+	std::vector<u32> sizes(chunk_count);
+	ParallelFor(chunk_count, workers, [&](size_t worker, size_t i) {
+		const u8* in = data + i * STATE_CHUNK_SIZE;
+		const size_t in_len = std::min<size_t>(STATE_CHUNK_SIZE, size - i * STATE_CHUNK_SIZE);
+		std::vector<u8>& chunk = chunks[i];
+
+		bool compressed = false;
+		if (codec == StateCodec::Zlib)
+		{
+			uLongf out_len = compressBound(static_cast<uLong>(in_len));
+			chunk.resize(out_len);
+			compressed = compress2(chunk.data(), &out_len, in, static_cast<uLong>(in_len),
+				std::max(1, std::min(level, 9))) == Z_OK;
+			chunk.resize(out_len);
+		}
+		else
+		{
+			if (work_memory[worker].empty())
+				work_memory[worker].resize(LZO1X_1_MEM_COMPRESS);
+			lzo_uint out_len = in_len + in_len / 16 + 64 + 3;
+			chunk.resize(out_len);
+			compressed = lzo1x_1_compress(in, static_cast<lzo_uint>(in_len), chunk.data(), &out_len,
+				work_memory[worker].data()) == LZO_E_OK;
+			chunk.resize(out_len);
+		}
+
+		if (!compressed || chunk.size() >= in_len)
+		{
+			chunk.assign(in, in + in_len);
+			sizes[i] = static_cast<u32>(in_len) | STORED_CHUNK_FLAG;
+		}
+		else
+		{
+			sizes[i] = static_cast<u32>(chunk.size());
+		}
+	});
+
+	ChunkedStateHeader header = { CHUNKED_STATE_MAGIC, static_cast<u32>(codec), STATE_CHUNK_SIZE,
+		static_cast<u32>(chunk_count) };
+	size_t total = sizeof(header) + chunk_count * sizeof(u32);
+	for (const std::vector<u8>& chunk : chunks)
+		total += chunk.size();
+
+	const size_t start = out->size();
+	out->resize(start + total);
+	u8* dest = out->data() + start;
+	memcpy(dest, &header, sizeof(header));
+	dest += sizeof(header);
+	memcpy(dest, sizes.data(), chunk_count * sizeof(u32));
+	dest += chunk_count * sizeof(u32);
+	for (const std::vector<u8>& chunk : chunks)
+	{
+		memcpy(dest, chunk.data(), chunk.size());
+		dest += chunk.size();
+	}
+}
+
+// Decompresses a state made by CompressState straight into out, which must be exactly
+// as large as the uncompressed state.
+static bool DecompressState(const u8* data, size_t size, u8* out, size_t out_size)
+{
+	ChunkedStateHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != CHUNKED_STATE_MAGIC || header.chunk_size == 0 ||
+		header.chunk_count != (out_size + header.chunk_size - 1) / header.chunk_size ||
+		size - sizeof(header) < header.chunk_count * sizeof(u32))
+	{
+		return false;
+	}
+
+	std::vector<u32> sizes(header.chunk_count);
+	memcpy(sizes.data(), data + sizeof(header), header.chunk_count * sizeof(u32));
+
+	// Offsets of the chunks in data.
+	std::vector<size_t> offsets(header.chunk_count);
+	size_t offset = sizeof(header) + header.chunk_count * sizeof(u32);
+	for (u32 i = 0; i < header.chunk_count; ++i)
+	{
+		offsets[i] = offset;
+		offset += sizes[i] & ~STORED_CHUNK_FLAG;
+	}
+	if (offset > size)
+		return false;
+
+	std::atomic<bool> success(true);
+	ParallelFor(header.chunk_count, GetWorkerCount(header.chunk_count), [&](size_t, size_t i) {
+		const u8* in = data + offsets[i];
+		const u32 in_len = sizes[i] & ~STORED_CHUNK_FLAG;
+		u8* dest = out + i * header.chunk_size;
+		const size_t dest_len = std::min<size_t>(header.chunk_size, out_size - i * header.chunk_size);
+
+		if (sizes[i] & STORED_CHUNK_FLAG)
+		{
+			if (in_len != dest_len)
+				success = false;
+			else
+				memcpy(dest, in, in_len);
+		}
+		else if (header.codec == static_cast<u32>(StateCodec::Zlib))
+		{
+			uLongf out_len = static_cast<uLongf>(dest_len);
+			if (uncompress(dest, &out_len, in, in_len) != Z_OK || out_len != dest_len)
+				success = false;
+		}
+		else
+		{
+			lzo_uint out_len = dest_len;
+			if (lzo1x_decompress_safe(in, in_len, dest, &out_len, nullptr) != LZO_E_OK ||
+				out_len != dest_len)
+			{
+				success = false;
+			}
+		}
+	});
+	return success;
+}
+
 // Returns true if state version matches current Dolphin state version, false otherwise.
 static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
 {
@@ -184,16 +349,16 @@ static std::string DoState(PointerWrap& p)
 	return version_created_by;
 }
 
-void LoadFromBuffer(std::vector<u8>& buffer)
+bool LoadFromBuffer(std::vector<u8>& buffer)
 {
 	if ((NetPlay::IsNetPlayRunning()) && (netplay_client->GetPlayers().size() != 1))
 	{
 		OSD::AddMessage("Loading savestates is disabled in multiplayer Netplay lobbies to prevent desyncs");
-		return;
+		return false;
 	}
 	else if (IsOnline())
 	{
-		return; // No loading states when online on slippi either
+		return false; // No loading states when online on slippi either
 	}
 
 	bool wasUnpaused = Core::PauseAndLock(true);
@@ -203,22 +368,30 @@ void LoadFromBuffer(std::vector<u8>& buffer)
 	DoState(p);
 
 	Core::PauseAndLock(false, wasUnpaused);
+	return p.GetMode() == PointerWrap::MODE_READ;
 }
 
-void SaveToBuffer(std::vector<u8>& buffer)
+// Saves the state in a single pass, using all of the buffer's capacity before growing it.
+// Callers which keep their buffer around (playback seeking, the undo buffer, SaveAs) only
+// allocate when the state gets bigger than it has ever been.
+static PointerWrap::Mode DoStateToBuffer(std::vector<u8>& buffer)
 {
-	bool wasUnpaused = Core::PauseAndLock(true);
-
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+	buffer.resize(buffer.capacity());
 
+	u8* ptr = buffer.data();
+	PointerWrap p(&ptr, &buffer);
 	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-	buffer.resize(buffer_size);
 
-	ptr = &buffer[0];
-	p.SetMode(PointerWrap::MODE_WRITE);
-	DoState(p);
+	// If the save was aborted, ptr kept moving without writing anything.
+	buffer.resize(std::min<size_t>(ptr - buffer.data(), buffer.size()));
+	return p.GetMode();
+}
+
+void SaveToBuffer(std::vector<u8>& buffer)
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	DoStateToBuffer(buffer);
 
 	Core::PauseAndLock(false, wasUnpaused);
 }
@@ -349,33 +522,11 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	if (header.size != 0)  // non-zero header size means the state is compressed
 	{
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
-
-			if ((i + IN_LEN) >= buffer_size)
-			{
-				cur_len = (lzo_uint32)(buffer_size - i);
-			}
-			else
-			{
-				cur_len = IN_LEN;
-			}
-
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
-			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
-		}
+		const SConfig& config = SConfig::GetInstance();
+		std::vector<u8> compressed;
+		CompressState(buffer_data, buffer_size, static_cast<StateCodec>(config.iStateCodec),
+			config.iStateCompressionLevel, &compressed);
+		f.WriteBytes(compressed.data(), compressed.size());
 	}
 	else  // uncompressed
 	{
@@ -391,22 +542,13 @@ void SaveAs(const std::string& filename, bool wait)
 	// Pause the core while we save the state
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	// Measure the size of the buffer.
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-	// Then actually do the write.
+	PointerWrap::Mode mode;
 	{
 		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-		g_current_buffer.resize(buffer_size);
-		ptr = &g_current_buffer[0];
-		p.SetMode(PointerWrap::MODE_WRITE);
-		DoState(p);
+		mode = DoStateToBuffer(g_current_buffer);
 	}
 
-	if (p.GetMode() == PointerWrap::MODE_WRITE)
+	if (mode == PointerWrap::MODE_WRITE)
 	{
 		Core::DisplayMessage("Saving State...", 1000);
 
@@ -487,27 +629,48 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
 		buffer.resize(header.size);
 
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;    // number of bytes to write
-
-			if (!f.ReadArray(&cur_len, 1))
-				break;
+		u32 magic = 0;
+		if (!f.ReadArray(&magic, 1))
+			return;
+		f.Seek(sizeof(StateHeader), SEEK_SET);
 
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-			if (res != LZO_E_OK)
+		if (magic == CHUNKED_STATE_MAGIC)
+		{
+			std::vector<u8> compressed((size_t)(f.GetSize() - sizeof(StateHeader)));
+			if (!f.ReadBytes(compressed.data(), compressed.size()) ||
+				!DecompressState(compressed.data(), compressed.size(), buffer.data(), buffer.size()))
 			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again",
-					res, i, new_len);
+				PanicAlertT("Failed to decompress the state");
 				return;
 			}
-
-			i += new_len;
+		}
+		else
+		{
+			std::vector<u8> in(LEGACY_OUT_LEN);
+			lzo_uint i = 0;
+			while (true)
+			{
+				lzo_uint32 cur_len = 0;  // number of bytes to read
+				lzo_uint new_len = buffer.size() - i;  // number of bytes to write
+
+				if (!f.ReadArray(&cur_len, 1))
+					break;
+
+				if (cur_len > in.size())
+					in.resize(cur_len);
+				f.ReadBytes(in.data(), cur_len);
+				const int res = lzo1x_decompress_safe(in.data(), cur_len, &buffer[i], &new_len, nullptr);
+				if (res != LZO_E_OK)
+				{
+					// This doesn't seem to happen anymore.
+					PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
+						"Try loading the state again",
+						res, i, new_len);
+					return;
+				}
+
+				i += new_len;
+			}
 		}
 	}
 	else  // uncompressed
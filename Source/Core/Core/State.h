@@ -23,6 +23,13 @@ struct StateHeader
 	double time;
 };
 
+// Codec used to compress the chunks of new states (Core/StateCodec).
+enum class StateCodec : u32
+{
+	LZO = 0,
+	Zlib = 1,
+};
+
 void Init();
 
 void Shutdown();
@@ -49,7 +56,8 @@ void LoadAs(const std::string& filename);
 void VerifyAt(const std::string& filename);
 
 void SaveToBuffer(std::vector<u8>& buffer);
-void LoadFromBuffer(std::vector<u8>& buffer);
+// Returns false if the state couldn't be loaded, or loading states is disabled (netplay).
+bool LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
 void LoadLastSaved(int i = 1);
@@ -159,9 +159,17 @@ std::unique_ptr<IBlobReader> CreateBlobReader(const std::string& filename);
 
 typedef bool (*CompressCB)(const std::string& text, float percent, void* arg);
 
+// Codec used for the blocks of a GCZ image. LZO compresses worse than zlib,
+// but several times faster in both directions.
+enum class GCZCodec : u32
+{
+  Zlib = 0,
+  LZO = 1,
+};
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type = 0, int sector_size = 16384, CompressCB callback = nullptr,
-                        void* arg = nullptr);
+                        void* arg = nullptr, GCZCodec codec = GCZCodec::Zlib);
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
                           CompressCB callback = nullptr, void* arg = nullptr);
 
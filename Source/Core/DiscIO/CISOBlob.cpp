@@ -5,15 +5,18 @@
 #include <algorithm>
 #include <cstdio>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/CISOBlob.h"
 
 namespace DiscIO
 {
-CISOFileReader::CISOFileReader(File::IOFile file) : m_file(std::move(file))
+CISOFileReader::CISOFileReader(File::IOFile file, const std::string& path)
+    : m_file(std::move(file))
 {
   m_size = m_file.GetSize();
 
@@ -26,13 +29,18 @@ CISOFileReader::CISOFileReader(File::IOFile file) : m_file(std::move(file))
   MapType count = 0;
   for (u32 idx = 0; idx < CISO_MAP_SIZE; ++idx)
     m_ciso_map[idx] = (1 == header.map[idx]) ? count++ : UNUSED_BLOCK_ID;
+
+  if (m_mapped_file.Open(path) && m_mapped_file.GetSize() == m_size)
+    m_file.Close();
+  else
+    m_mapped_file.Close();
 }
 
-std::unique_ptr<CISOFileReader> CISOFileReader::Create(File::IOFile file)
+std::unique_ptr<CISOFileReader> CISOFileReader::Create(File::IOFile file, const std::string& path)
 {
   CISOHeader header;
   if (file.Seek(0, SEEK_SET) && file.ReadArray(&header, 1) && header.magic == CISO_MAGIC)
-    return std::unique_ptr<CISOFileReader>(new CISOFileReader(std::move(file)));
+    return std::unique_ptr<CISOFileReader>(new CISOFileReader(std::move(file), path));
 
   return nullptr;
 }
@@ -60,7 +68,12 @@ bool CISOFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
       // calculate the base address
       u64 const file_off = CISO_HEADER_SIZE + m_ciso_map[block] * (u64)m_block_size + data_offset;
 
-      if (!(m_file.Seek(file_off, SEEK_SET) && m_file.ReadArray(out_ptr, bytes_to_read)))
+      if (m_mapped_file.IsOpen())
+      {
+        if (!m_mapped_file.Read(file_off, bytes_to_read, out_ptr))
+          return false;
+      }
+      else if (!(m_file.Seek(file_off, SEEK_SET) && m_file.ReadArray(out_ptr, bytes_to_read)))
       {
         m_file.Clear();
         return false;
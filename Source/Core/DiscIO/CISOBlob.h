@@ -10,6 +10,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -34,7 +35,7 @@ struct CISOHeader
 class CISOFileReader : public IBlobReader
 {
 public:
-  static std::unique_ptr<CISOFileReader> Create(File::IOFile file);
+  static std::unique_ptr<CISOFileReader> Create(File::IOFile file, const std::string& path);
 
   BlobType GetBlobType() const override { return BlobType::CISO; }
   // The CISO format does not save the original file size.
@@ -45,11 +46,13 @@ public:
   bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
 
 private:
-  CISOFileReader(File::IOFile file);
+  CISOFileReader(File::IOFile file, const std::string& path);
 
   typedef u16 MapType;
   static const MapType UNUSED_BLOCK_ID = -1;
 
+  // Like PlainFileReader, m_file is only used when the file couldn't be mapped.
+  File::MappedFile m_mapped_file;
   File::IOFile m_file;
   u64 m_size;
   u32 m_block_size;
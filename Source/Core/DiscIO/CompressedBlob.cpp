@@ -15,14 +15,18 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include <lzo/lzo1x.h>
 #include <zlib.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -31,14 +35,22 @@ namespace DiscIO
 {
 bool IsGCZBlob(File::IOFile& file);
 
-CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string& filename)
-    : m_file(std::move(file)), m_file_name(filename)
+// Decompressed data the blocks following a sequential read are prefetched up to.
+static const u32 READ_AHEAD_SIZE = 1024 * 1024;
+static const u32 MIN_CACHED_BLOCKS = 16;
+static const int MAX_WORKERS = 4;
+
+CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string& filename,
+                                           u32 cache_size)
+    : m_file_name(filename), m_file(std::move(file))
 {
   m_file_size = m_file.GetSize();
   m_file.Seek(0, SEEK_SET);
   m_file.ReadArray(&m_header, 1);
+  m_codec = static_cast<GCZCodec>(m_header.sub_type >> GCZ_CODEC_SHIFT);
 
-  SetSectorSize(m_header.block_size);
+  // Read() is overridden and serves blocks from our own cache, so the SectorReader
+  // cache lines are left unallocated.
 
   // cache block pointers and hashes
   m_block_pointers.resize(m_header.num_blocks);
@@ -50,33 +62,57 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
                   (sizeof(u64)) * m_header.num_blocks     // skip block pointers
                   + (sizeof(u32)) * m_header.num_blocks;  // skip hashes
 
-  // A compressed block is never ever longer than a decompressed block, so just header.block_size
-  // should be fine.
-  // I still add some safety margin.
-  const u32 zlib_buffer_size = m_header.block_size + 64;
-  m_zlib_buffer.resize(zlib_buffer_size);
+  // A single request and the read-ahead window both stay well below the cache size,
+  // so the blocks a reader is waiting for are never the ones being evicted.
+  const u32 block_size = std::max<u32>(m_header.block_size, 1);
+  m_cache_capacity = std::max<u32>(cache_size / block_size, MIN_CACHED_BLOCKS);
+  m_max_blocks_per_request = static_cast<u32>(m_cache_capacity / 4);
+  m_read_ahead_blocks = std::min(std::max(READ_AHEAD_SIZE / block_size, 1u), m_max_blocks_per_request);
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
                                                                    const std::string& filename)
 {
   if (IsGCZBlob(file))
-    return std::unique_ptr<CompressedBlobReader>(
-        new CompressedBlobReader(std::move(file), filename));
+  {
+    const u32 cache_size = static_cast<u32>(std::max(SConfig::GetInstance().iGCZCacheSize, 1))
+                           << 20;
+    std::unique_ptr<CompressedBlobReader> reader(
+        new CompressedBlobReader(std::move(file), filename, cache_size));
+    if (reader->m_codec == GCZCodec::LZO && lzo_init() == LZO_E_OK)
+      return reader;
+    if (reader->m_codec == GCZCodec::Zlib)
+      return reader;
+    ERROR_LOG(DISCIO, "%s uses an unsupported compression codec (sub type %08x)",
+              filename.c_str(), reader->m_header.sub_type);
+  }
 
   return nullptr;
 }
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  {
+    std::lock_guard<std::mutex> lk(m_cache_lock);
+    m_stop_workers = true;
+    m_tasks.clear();
+  }
+  m_task_queued.notify_all();
+  for (std::thread& worker : m_workers)
+    worker.join();
+}
+
+u64 CompressedBlobReader::GetBlockOffset(u64 block_num) const
+{
+  // The top bit marks blocks stored uncompressed.
+  return m_block_pointers[block_num] & ~(1ULL << 63);
 }
 
-// IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
 u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 {
-  u64 start = m_block_pointers[block_num];
+  u64 start = GetBlockOffset(block_num);
   if (block_num < m_header.num_blocks - 1)
-    return m_block_pointers[block_num + 1] - start;
+    return GetBlockOffset(block_num + 1) - start;
   else if (block_num == m_header.num_blocks - 1)
     return m_header.compressed_data_size - start;
   else
@@ -84,75 +120,518 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
   return 0;
 }
 
+bool CompressedBlobReader::Read(u64 offset, u64 size, u8* out_ptr)
+{
+  // Replaces the SectorReader cache: blocks are copied straight out of the LRU cache.
+  const u32 block_size = m_header.block_size;
+  u64 block_num = offset / block_size;
+  u32 position_in_block = static_cast<u32>(offset % block_size);
+  std::vector<BlockData> blocks;
+
+  while (size > 0)
+  {
+    const u64 last_block = (block_num * block_size + position_in_block + size - 1) / block_size;
+    const u32 num_blocks =
+        static_cast<u32>(std::min<u64>(last_block - block_num + 1, m_max_blocks_per_request));
+    blocks.resize(num_blocks);
+    if (!AcquireBlocks(block_num, num_blocks, blocks.data()))
+      return false;
+
+    for (const BlockData& block : blocks)
+    {
+      const u32 to_copy = static_cast<u32>(std::min<u64>(block_size - position_in_block, size));
+      std::copy_n(block->data() + position_in_block, to_copy, out_ptr);
+      out_ptr += to_copy;
+      size -= to_copy;
+      position_in_block = 0;
+    }
+    block_num += num_blocks;
+  }
+  return true;
+}
+
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
-  u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-  u64 offset = m_block_pointers[block_num] + m_data_offset;
+  return ReadMultipleAlignedBlocks(block_num, 1, out_ptr);
+}
+
+bool CompressedBlobReader::ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr)
+{
+  return Read(block_num * m_header.block_size, num_blocks * m_header.block_size, out_ptr);
+}
 
-  if (offset & (1ULL << 63))
+bool CompressedBlobReader::AcquireBlocks(u64 block_num, u32 num_blocks, BlockData* out)
+{
+  if (block_num >= m_header.num_blocks || num_blocks > m_header.num_blocks - block_num)
+    return false;
+
+  // Blocks nobody has asked for yet. Their compressed data is read with a single
+  // request below, then they are inflated by this thread and the workers together.
+  std::vector<u64> missing;
+  std::vector<u8> compressed;
   {
-    if (comp_block_size != m_header.block_size)
-      PanicAlert("Uncompressed block with wrong size");
-    uncompressed = true;
-    offset &= ~(1ULL << 63);
+    std::lock_guard<std::mutex> lk(m_cache_lock);
+    for (u32 i = 0; i < num_blocks; ++i)
+    {
+      auto it = m_cache.find(block_num + i);
+      if (it == m_cache.end())
+      {
+        out[i] = nullptr;
+        InsertPendingBlock(block_num + i);
+        missing.push_back(block_num + i);
+        continue;
+      }
+      out[i] = it->second.data;
+      if (out[i])
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+    }
   }
 
-  // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  if (!missing.empty() && !ReadCompressedBlocks(missing.front(),
+                                                static_cast<u32>(missing.back() - missing.front() + 1),
+                                                &compressed))
+  {
+    std::lock_guard<std::mutex> lk(m_cache_lock);
+    for (u64 block : missing)
+    {
+      auto it = m_cache.find(block);
+      m_lru.erase(it->second.lru_position);
+      m_cache.erase(it);
+    }
+    m_block_done.notify_all();
+    return false;
+  }
 
-  m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  const u64 compressed_start = missing.empty() ? 0 : GetBlockOffset(missing.front());
+  std::vector<u8> read_buffer;
+  if (missing.size() == 1)
+  {
+    RunTask({missing.front(), compressed.data()}, &read_buffer);
+    missing.clear();
+  }
+
+  std::unique_lock<std::mutex> lk(m_cache_lock);
+  if (!missing.empty())
+  {
+    StartWorkers();
+    // Ahead of any read-ahead work, in block order.
+    for (auto it = missing.rbegin(); it != missing.rend(); ++it)
+      m_tasks.push_front({*it, compressed.data() + (GetBlockOffset(*it) - compressed_start)});
+    m_task_queued.notify_all();
+  }
+
+  // Reads usually don't start on a block boundary, so a sequential stream
+  // re-reads the last block of the previous request. It must go past it, though:
+  // probing a header reads the same block over and over.
+  if (block_num <= m_next_sequential_block && m_next_sequential_block < block_num + num_blocks)
+    QueueReadAhead(block_num + num_blocks);
+  m_next_sequential_block = block_num + num_blocks;
+
+  // Even after a failure, keep waiting for the remaining blocks: until they are done,
+  // the workers may still be reading from our compressed buffer.
+  bool success = true;
+  for (u32 i = 0; i < num_blocks; ++i)
+  {
+    while (!out[i])
+    {
+      const u64 block = block_num + i;
+      auto it = m_cache.find(block);
+      if (it == m_cache.end())
+      {
+        // Another reader dropped the block after it failed, or it was evicted before
+        // we got to it. Either way, decompress it once more without caching it.
+        lk.unlock();
+        std::vector<u8> data(m_header.block_size);
+        if (ReadCompressedBlocks(block, 1, &read_buffer) &&
+            DecompressBlock(block, read_buffer.data(), data.data()))
+        {
+          out[i] = std::make_shared<const std::vector<u8>>(std::move(data));
+        }
+        lk.lock();
+        if (!out[i])
+        {
+          success = false;
+          break;
+        }
+        continue;
+      }
+
+      if (it->second.data)
+      {
+        out[i] = it->second.data;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+        break;
+      }
+
+      if (it->second.failed)
+      {
+        // Dropped so that the next read of this block tries again.
+        m_lru.erase(it->second.lru_position);
+        m_cache.erase(it);
+        success = false;
+        break;
+      }
+
+      // Still pending. Rather than wait for a worker to get to it, do it ourselves.
+      auto task = std::find_if(m_tasks.begin(), m_tasks.end(),
+                               [block](const DecompressTask& t) { return t.block_num == block; });
+      if (task != m_tasks.end())
+      {
+        const DecompressTask to_run = *task;
+        m_tasks.erase(task);
+        lk.unlock();
+        RunTask(to_run, &read_buffer);
+        lk.lock();
+        continue;
+      }
+
+      m_block_done.wait(lk);
+    }
+  }
+
+  return success;
+}
+
+void CompressedBlobReader::QueueReadAhead(u64 block_num)
+{
+  const u64 end = std::min<u64>(block_num + m_read_ahead_blocks, m_header.num_blocks);
+  bool queued = false;
+  for (u64 block = block_num; block < end; ++block)
+  {
+    if (m_cache.count(block))
+      continue;
+    InsertPendingBlock(block);
+    m_tasks.push_back({block, nullptr});
+    queued = true;
+  }
+
+  if (queued)
+  {
+    StartWorkers();
+    m_task_queued.notify_all();
+  }
+}
+
+void CompressedBlobReader::StartWorkers()
+{
+  // Started on first use: most readers are only opened to look at the banner.
+  if (!m_workers.empty())
+    return;
+
+  const int count = std::min(std::max(cpu_info.logical_cpu_count - 1, 1), MAX_WORKERS);
+  for (int i = 0; i < count; ++i)
+    m_workers.emplace_back(&CompressedBlobReader::WorkerLoop, this);
+}
+
+void CompressedBlobReader::WorkerLoop()
+{
+  Common::SetCurrentThreadName("GCZ Worker");
+  std::vector<u8> read_buffer;
+
+  std::unique_lock<std::mutex> lk(m_cache_lock);
+  while (true)
+  {
+    m_task_queued.wait(lk, [this] { return m_stop_workers || !m_tasks.empty(); });
+    if (m_stop_workers)
+      return;
+
+    const DecompressTask task = m_tasks.front();
+    m_tasks.pop_front();
+    lk.unlock();
+    RunTask(task, &read_buffer);
+    lk.lock();
+  }
+}
+
+void CompressedBlobReader::RunTask(const DecompressTask& task, std::vector<u8>* read_buffer)
+{
+  const u8* compressed = task.compressed;
+  if (!compressed && ReadCompressedBlocks(task.block_num, 1, read_buffer))
+    compressed = read_buffer->data();
+
+  std::shared_ptr<std::vector<u8>> data;
+  if (compressed)
+  {
+    data = std::make_shared<std::vector<u8>>(m_header.block_size);
+    if (!DecompressBlock(task.block_num, compressed, data->data()))
+      data.reset();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_cache_lock);
+    auto it = m_cache.find(task.block_num);
+    if (it != m_cache.end())
+    {
+      it->second.data = data;
+      it->second.failed = !data;
+    }
+  }
+  m_block_done.notify_all();
+}
+
+void CompressedBlobReader::InsertPendingBlock(u64 block_num)
+{
+  m_lru.push_front(block_num);
+  CacheEntry& entry = m_cache[block_num];
+  entry.lru_position = m_lru.begin();
+  EvictBlocks();
+}
+
+void CompressedBlobReader::EvictBlocks()
+{
+  auto it = m_lru.end();
+  while (m_cache.size() > m_cache_capacity && it != m_lru.begin())
+  {
+    --it;
+    auto entry = m_cache.find(*it);
+    // Pending blocks have someone waiting for them.
+    if (!entry->second.data && !entry->second.failed)
+      continue;
+    m_cache.erase(entry);
+    it = m_lru.erase(it);
+  }
+}
+
+bool CompressedBlobReader::ReadCompressedBlocks(u64 block_num, u32 num_blocks,
+                                                std::vector<u8>* buffer)
+{
+  const u64 last_block = block_num + num_blocks - 1;
+  const u64 start = GetBlockOffset(block_num);
+  const u64 size = GetBlockOffset(last_block) + GetBlockCompressedSize(last_block) - start;
+  buffer->resize(size);
+
+  std::lock_guard<std::mutex> lk(m_file_lock);
+  m_file.Seek(m_data_offset + start, SEEK_SET);
+  if (!m_file.ReadBytes(buffer->data(), size))
   {
     PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
                 m_file_name.c_str());
     m_file.Clear();
     return false;
   }
+  return true;
+}
+
+bool CompressedBlobReader::DecompressBlock(u64 block_num, const u8* compressed, u8* out_ptr) const
+{
+  const u32 comp_block_size = static_cast<u32>(GetBlockCompressedSize(block_num));
 
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(compressed, comp_block_size);
   if (block_hash != m_hashes[block_num])
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
                 m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
 
-  if (uncompressed)
+  if (m_block_pointers[block_num] & (1ULL << 63))
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    if (comp_block_size != m_header.block_size)
+    {
+      PanicAlert("Uncompressed block with wrong size");
+      return false;
+    }
+    std::copy_n(compressed, comp_block_size, out_ptr);
+    return true;
   }
-  else
+
+  if (m_codec == GCZCodec::LZO)
+    return DecompressLZO(block_num, compressed, comp_block_size, out_ptr);
+  return Inflate(block_num, compressed, comp_block_size, out_ptr);
+}
+
+bool CompressedBlobReader::Inflate(u64 block_num, const u8* compressed, u32 compressed_size,
+                                   u8* out_ptr) const
+{
+  z_stream z = {};
+  z.next_in = const_cast<u8*>(compressed);
+  z.avail_in = compressed_size;
+  if (z.avail_in > m_header.block_size)
+  {
+    PanicAlert("We have a problem");
+  }
+  z.next_out = out_ptr;
+  z.avail_out = m_header.block_size;
+  inflateInit(&z);
+  int status = inflate(&z, Z_FULL_FLUSH);
+  u32 uncomp_size = m_header.block_size - z.avail_out;
+  if (status != Z_STREAM_END)
+  {
+    // this seem to fire wrongly from time to time
+    // to be sure, don't use compressed isos :P
+    PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
+  }
+  inflateEnd(&z);
+  if (uncomp_size != m_header.block_size)
+  {
+    PanicAlert("Wrong block size");
+    return false;
+  }
+  return true;
+}
+
+bool CompressedBlobReader::DecompressLZO(u64 block_num, const u8* compressed, u32 compressed_size,
+                                         u8* out_ptr) const
+{
+  lzo_uint uncomp_size = m_header.block_size;
+  int status = lzo1x_decompress_safe(compressed, compressed_size, out_ptr, &uncomp_size, nullptr);
+  if (status != LZO_E_OK || uncomp_size != m_header.block_size)
+  {
+    PanicAlert("Failure reading block %" PRIu64 " - LZO error %d.", block_num, status);
+    return false;
+  }
+  return true;
+}
+
+namespace
+{
+// Compresses the blocks of CompressFileToBlob on all cores. The caller reads a block into
+// a slot, submits it and later waits for it in the same order, so slots are reused round
+// robin and the output stays in block order.
+class BlockCompressor final
+{
+public:
+  struct Slot
+  {
+    std::vector<u8> in;
+    std::vector<u8> out;
+    u32 size = 0;
+    bool stored = false;
+    bool failed = false;
+    bool done = false;
+    u32 hash = 0;
+  };
+
+  BlockCompressor(GCZCodec codec, u32 block_size) : m_codec(codec), m_block_size(block_size)
+  {
+    const int thread_count = std::max(cpu_info.logical_cpu_count, 1);
+    // Enough slots that the reading thread never has to wait on a worker to get ahead.
+    m_slots.resize(thread_count * 4);
+    for (Slot& slot : m_slots)
+    {
+      slot.in.resize(block_size);
+      // LZO may expand incompressible data a little.
+      slot.out.resize(block_size + block_size / 16 + 64 + 3);
+    }
+    for (int i = 0; i < thread_count; ++i)
+      m_threads.emplace_back(&BlockCompressor::WorkerLoop, this);
+  }
+
+  ~BlockCompressor()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_stop = true;
+    }
+    m_work_queued.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+  }
+
+  u32 GetSlotCount() const { return static_cast<u32>(m_slots.size()); }
+  Slot& GetSlot(u32 block_num) { return m_slots[block_num % m_slots.size()]; }
+
+  void Submit(u32 block_num)
+  {
+    Slot& slot = GetSlot(block_num);
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      slot.done = false;
+      m_queue.push_back(&slot);
+    }
+    m_work_queued.notify_one();
+  }
+
+  Slot& Wait(u32 block_num)
   {
+    Slot& slot = GetSlot(block_num);
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_work_done.wait(lk, [&slot] { return slot.done; });
+    return slot;
+  }
+
+private:
+  void WorkerLoop()
+  {
+    Common::SetCurrentThreadName("GCZ Compressor");
+
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
-    z.avail_in = comp_block_size;
-    if (z.avail_in > m_header.block_size)
+    std::vector<u8> lzo_work_memory;
+    if (m_codec == GCZCodec::LZO)
+      lzo_work_memory.resize(LZO1X_1_MEM_COMPRESS);
+    else
+      deflateInit(&z, 9);
+
+    std::unique_lock<std::mutex> lk(m_lock);
+    while (true)
     {
-      PanicAlert("We have a problem");
+      m_work_queued.wait(lk, [this] { return m_stop || !m_queue.empty(); });
+      if (m_stop)
+        break;
+
+      Slot* slot = m_queue.front();
+      m_queue.pop_front();
+      lk.unlock();
+      Compress(slot, &z, lzo_work_memory.data());
+      lk.lock();
+      slot->done = true;
+      m_work_done.notify_all();
     }
-    z.next_out = out_ptr;
-    z.avail_out = m_header.block_size;
-    inflateInit(&z);
-    int status = inflate(&z, Z_FULL_FLUSH);
-    u32 uncomp_size = m_header.block_size - z.avail_out;
-    if (status != Z_STREAM_END)
+
+    if (m_codec == GCZCodec::Zlib)
+      deflateEnd(&z);
+  }
+
+  void Compress(Slot* slot, z_stream* z, u8* lzo_work_memory)
+  {
+    slot->failed = false;
+    u32 comp_size = 0;
+    bool compressed = false;
+    if (m_codec == GCZCodec::LZO)
     {
-      // this seem to fire wrongly from time to time
-      // to be sure, don't use compressed isos :P
-      PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
+      lzo_uint out_size = 0;
+      compressed = lzo1x_1_compress(slot->in.data(), m_block_size, slot->out.data(), &out_size,
+                                    lzo_work_memory) == LZO_E_OK &&
+                   out_size + 10 <= m_block_size;
+      comp_size = static_cast<u32>(out_size);
     }
-    inflateEnd(&z);
-    if (uncomp_size != m_header.block_size)
+    else
     {
-      PanicAlert("Wrong block size");
-      return false;
+      if (deflateReset(z) != Z_OK)
+      {
+        slot->failed = true;
+        return;
+      }
+      z->next_in = slot->in.data();
+      z->avail_in = m_block_size;
+      z->next_out = slot->out.data();
+      z->avail_out = m_block_size;
+      int status = deflate(z, Z_FINISH);
+      compressed = status == Z_STREAM_END && z->avail_out >= 10;
+      comp_size = m_block_size - z->avail_out;
     }
+
+    // Blocks that don't compress well are stored as-is.
+    slot->stored = !compressed;
+    slot->size = compressed ? comp_size : m_block_size;
+    slot->hash = HashAdler32(compressed ? slot->out.data() : slot->in.data(), slot->size);
   }
-  return true;
-}
+
+  const GCZCodec m_codec;
+  const u32 m_block_size;
+  std::vector<Slot> m_slots;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_lock;
+  std::condition_variable m_work_queued;
+  std::condition_variable m_work_done;
+  std::deque<Slot*> m_queue;
+  bool m_stop = false;
+};
+}  // namespace
 
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
-                        u32 sub_type, int block_size, CompressCB callback, void* arg)
+                        u32 sub_type, int block_size, CompressCB callback, void* arg,
+                        GCZCodec codec)
 {
   bool scrubbing = false;
 
@@ -179,6 +658,9 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     return false;
   }
 
+  // IsGCZBlob has read the start of the file.
+  infile.Seek(0, SEEK_SET);
+
   DiscScrubber disc_scrubber;
   if (sub_type == 1)
   {
@@ -192,15 +674,17 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
+  if (codec == GCZCodec::LZO && lzo_init() != LZO_E_OK)
+  {
+    PanicAlertT("Internal LZO Error - lzo_init() failed");
     return false;
+  }
 
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
   header.magic_cookie = GCZ_MAGIC;
-  header.sub_type = sub_type;
+  header.sub_type = sub_type | (static_cast<u32>(codec) << GCZ_CODEC_SHIFT);
   header.block_size = block_size;
   header.data_size = infile.GetSize();
 
@@ -209,8 +693,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -224,8 +706,54 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
+  // Reading and writing happen on this thread, while the blocks in between are compressed
+  // by the workers.
+  BlockCompressor compressor(codec, block_size);
+  auto write_block = [&](u32 block_num) {
+    const BlockCompressor::Slot& slot = compressor.Wait(block_num);
+    if (slot.failed)
+    {
+      ERROR_LOG(DISCIO, "Deflate failed");
+      return false;
+    }
+
+    offsets[block_num] = position;
+    if (slot.stored)
+    {
+      offsets[block_num] |= 0x8000000000000000ULL;
+      num_stored++;
+    }
+    else
+    {
+      num_compressed++;
+    }
+
+    if (!outfile.WriteBytes(slot.stored ? slot.in.data() : slot.out.data(), slot.size))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    position += slot.size;
+    hashes[block_num] = slot.hash;
+    return true;
+  };
+
+  u32 blocks_written = 0;
   for (u32 i = 0; i < header.num_blocks; i++)
   {
+    // Make room for this block by writing out the one that used its slot before.
+    if (i >= compressor.GetSlotCount())
+    {
+      if (!write_block(blocks_written++))
+      {
+        success = false;
+        break;
+      }
+    }
+
     if (i % progress_monitor == 0)
     {
       const u64 inpos = infile.Tell();
@@ -244,8 +772,7 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
       }
     }
 
-    offsets[i] = position;
-
+    std::vector<u8>& in_buf = compressor.GetSlot(i).in;
     size_t read_bytes;
     if (scrubbing)
       read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
@@ -254,56 +781,12 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     if (read_bytes < header.block_size)
       std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
 
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
-    {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
-
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
-
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
-
-    position += write_size;
-
-    hashes[i] = HashAdler32(write_buf, write_size);
+    compressor.Submit(i);
   }
 
+  while (success && blocks_written < header.num_blocks)
+    success = write_block(blocks_written++);
+
   header.compressed_data_size = position;
 
   if (!success)
@@ -321,9 +804,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
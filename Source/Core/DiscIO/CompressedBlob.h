@@ -13,8 +13,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -25,6 +31,10 @@ namespace DiscIO
 {
 static constexpr u32 GCZ_MAGIC = 0xB10BC001;
 
+// The upper half of sub_type holds the GCZCodec of the blocks. Images from before
+// codecs were selectable only ever have 0 (GC) or 1 (scrubbed Wii disc) in there.
+static constexpr u32 GCZ_CODEC_SHIFT = 16;
+
 // GCZ file structure:
 // BlobHeader
 // u64 offsetsToBlocks[n], top bit specifies whether the block is compressed, or not.
@@ -34,13 +44,16 @@ static constexpr u32 GCZ_MAGIC = 0xB10BC001;
 struct CompressedBlobHeader  // 32 bytes
 {
   u32 magic_cookie;  // 0xB10BB10B
-  u32 sub_type;      // GC image, whatever
+  u32 sub_type;      // GC image, whatever, and the codec (see GCZ_CODEC_SHIFT)
   u64 compressed_data_size;
   u64 data_size;
   u32 block_size;
   u32 num_blocks;
 };
 
+// Decompressed blocks are kept in an LRU cache sized by SConfig::iGCZCacheSize.
+// Reads spanning several blocks are inflated in parallel by a few worker threads,
+// which also decompress the blocks following a sequential read ahead of time.
 class CompressedBlobReader : public SectorReader
 {
 public:
@@ -52,19 +65,76 @@ public:
   u64 GetDataSize() const override { return m_header.data_size; }
   u64 GetRawSize() const override { return m_file_size; }
   u64 GetBlockCompressedSize(u64 block_num) const;
+  bool Read(u64 offset, u64 size, u8* out_ptr) override;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
+  bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr) override;
+
+  // Workers are only started by reads, so this is exact on the thread doing them.
+  size_t GetWorkerCount() const { return m_workers.size(); }
 
 private:
-  CompressedBlobReader(File::IOFile file, const std::string& filename);
+  using BlockData = std::shared_ptr<const std::vector<u8>>;
+
+  struct CacheEntry
+  {
+    BlockData data;  // nullptr while the block is being decompressed
+    std::list<u64>::iterator lru_position;
+    bool failed = false;
+  };
+
+  // compressed is nullptr when the worker has to read the block from the file itself.
+  struct DecompressTask
+  {
+    u64 block_num;
+    const u8* compressed;
+  };
+
+  CompressedBlobReader(File::IOFile file, const std::string& filename, u32 cache_size);
+
+  // Makes sure blocks [block_num, block_num + num_blocks) are decompressed and stores
+  // references to them in out. num_blocks must not exceed m_max_blocks_per_request.
+  bool AcquireBlocks(u64 block_num, u32 num_blocks, BlockData* out);
+  void QueueReadAhead(u64 block_num);
+  void StartWorkers();
+  void WorkerLoop();
+  void RunTask(const DecompressTask& task, std::vector<u8>* read_buffer);
+
+  u64 GetBlockOffset(u64 block_num) const;
+  bool ReadCompressedBlocks(u64 block_num, u32 num_blocks, std::vector<u8>* buffer);
+  bool DecompressBlock(u64 block_num, const u8* compressed, u8* out_ptr) const;
+  bool Inflate(u64 block_num, const u8* compressed, u32 compressed_size, u8* out_ptr) const;
+  bool DecompressLZO(u64 block_num, const u8* compressed, u32 compressed_size, u8* out_ptr) const;
+
+  // Must be called with m_cache_lock held.
+  void InsertPendingBlock(u64 block_num);
+  void EvictBlocks();
 
   CompressedBlobHeader m_header;
+  GCZCodec m_codec;
   std::vector<u64> m_block_pointers;
   std::vector<u32> m_hashes;
   int m_data_offset;
-  File::IOFile m_file;
   u64 m_file_size;
-  std::vector<u8> m_zlib_buffer;
   std::string m_file_name;
+
+  std::mutex m_file_lock;
+  File::IOFile m_file;
+
+  std::mutex m_cache_lock;
+  std::condition_variable m_block_done;
+  std::unordered_map<u64, CacheEntry> m_cache;
+  std::list<u64> m_lru;  // Most recently used first.
+  size_t m_cache_capacity;
+  u32 m_max_blocks_per_request;
+  u32 m_read_ahead_blocks;
+  // Block after the previous read, none before the first read.
+  u64 m_next_sequential_block = UINT64_MAX;
+
+  // Protected by m_cache_lock as well.
+  std::condition_variable m_task_queued;
+  std::deque<DecompressTask> m_tasks;
+  std::vector<std::thread> m_workers;
+  bool m_stop_workers = false;
 };
 
 }  // namespace
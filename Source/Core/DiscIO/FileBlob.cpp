@@ -10,21 +10,29 @@
 
 namespace DiscIO
 {
-PlainFileReader::PlainFileReader(File::IOFile file) : m_file(std::move(file))
+PlainFileReader::PlainFileReader(File::IOFile file, const std::string& path)
+    : m_file(std::move(file))
 {
   m_size = m_file.GetSize();
+  if (m_mapped_file.Open(path) && m_mapped_file.GetSize() == static_cast<u64>(m_size))
+    m_file.Close();
+  else
+    m_mapped_file.Close();
 }
 
-std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file)
+std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file, const std::string& path)
 {
   if (file)
-    return std::unique_ptr<PlainFileReader>(new PlainFileReader(std::move(file)));
+    return std::unique_ptr<PlainFileReader>(new PlainFileReader(std::move(file), path));
 
   return nullptr;
 }
 
 bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
+  if (m_mapped_file.IsOpen())
+    return m_mapped_file.Read(offset, nbytes, out_ptr);
+
   if (m_file.Seek(offset, SEEK_SET) && m_file.ReadBytes(out_ptr, nbytes))
   {
     return true;
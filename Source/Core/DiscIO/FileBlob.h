@@ -10,14 +10,17 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
 {
+// Reads are served from a read-only mapping of the image when possible, so that every
+// emulator instance reading the same image shares the kernel page cache.
 class PlainFileReader : public IBlobReader
 {
 public:
-  static std::unique_ptr<PlainFileReader> Create(File::IOFile file);
+  static std::unique_ptr<PlainFileReader> Create(File::IOFile file, const std::string& path);
 
   BlobType GetBlobType() const override { return BlobType::PLAIN; }
   u64 GetDataSize() const override { return m_size; }
@@ -25,8 +28,10 @@ public:
   bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
 
 private:
-  PlainFileReader(File::IOFile file);
+  PlainFileReader(File::IOFile file, const std::string& path);
 
+  // m_file is only used when the file couldn't be mapped.
+  File::MappedFile m_mapped_file;
   File::IOFile m_file;
   s64 m_size;
 };
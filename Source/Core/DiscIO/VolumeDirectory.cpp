@@ -6,7 +6,9 @@
 #include <cstddef>
 #include <cstring>
 #include <map>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -16,6 +18,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/FileMonitor.h"
@@ -109,50 +112,92 @@ bool CVolumeDirectory::Read(u64 offset, u64 length, u8* buffer, bool decrypt) co
 		return true;
 
 	// Determine which file the offset refers to
-	std::map<u64, std::string>::const_iterator fileIter = m_virtual_disk.lower_bound(offset);
-	if (fileIter->first > offset && fileIter != m_virtual_disk.begin())
-		--fileIter;
+	auto file_iter = std::upper_bound(m_virtual_disk.begin(), m_virtual_disk.end(), offset,
+		[](u64 address, const VirtualFile& file) { return address < file.offset; });
+	if (file_iter != m_virtual_disk.begin())
+		--file_iter;
 
 	// zero fill to start of file data
-	PadToAddress(fileIter->first, &offset, &length, &buffer);
+	PadToAddress(file_iter->offset, &offset, &length, &buffer);
 
-	while (fileIter != m_virtual_disk.end() && length > 0)
+	// The read may span several files, which are all read in this one pass.
+	std::lock_guard<std::mutex> lk(m_open_files_lock);
+	for (size_t index = file_iter - m_virtual_disk.begin();
+		index < m_virtual_disk.size() && length > 0; ++index)
 	{
-		_dbg_assert_(DVDINTERFACE, fileIter->first <= offset);
-		u64 fileOffset = offset - fileIter->first;
-		const std::string fileName = fileIter->second;
-
-		File::IOFile file(fileName, "rb");
-		if (!file)
+		_dbg_assert_(DVDINTERFACE, m_virtual_disk[index].offset <= offset);
+		if (!ReadFile(index, offset - m_virtual_disk[index].offset, &offset, &length, &buffer))
 			return false;
 
-		u64 fileSize = file.GetSize();
+		if (index + 1 < m_virtual_disk.size())
+		{
+			_dbg_assert_(DVDINTERFACE, m_virtual_disk[index + 1].offset >= offset);
+			PadToAddress(m_virtual_disk[index + 1].offset, &offset, &length, &buffer);
+		}
+	}
 
-		FileMon::CheckFile(fileName, fileSize);
+	return true;
+}
 
-		if (fileOffset < fileSize)
-		{
-			u64 fileBytes = std::min(fileSize - fileOffset, length);
+CVolumeDirectory::OpenFile* CVolumeDirectory::GetOpenFile(size_t index) const
+{
+	auto it = std::find_if(m_open_files.begin(), m_open_files.end(),
+		[index](const OpenFile& file) { return file.index == index; });
+	if (it != m_open_files.end())
+	{
+		m_open_files.splice(m_open_files.begin(), m_open_files, it);
+		return &m_open_files.front();
+	}
 
-			if (!file.Seek(fileOffset, SEEK_SET))
-				return false;
-			if (!file.ReadBytes(buffer, fileBytes))
-				return false;
+	const std::string& path = m_virtual_disk[index].path;
+	File::IOFile file(path, "rb");
+	if (!file)
+		return nullptr;
 
-			length -= fileBytes;
-			buffer += fileBytes;
-			offset += fileBytes;
-		}
+	if (m_open_files.size() >= MAX_OPEN_FILES)
+		m_open_files.pop_back();
 
-		++fileIter;
+	OpenFile open_file;
+	open_file.index = index;
+	open_file.size = file.GetSize();
+	open_file.mapped_file = std::make_unique<File::MappedFile>();
+	if (open_file.mapped_file->Open(path) && open_file.mapped_file->GetSize() == open_file.size)
+		file.Close();
+	else
+		open_file.mapped_file.reset();
+	open_file.file = std::move(file);
 
-		if (fileIter != m_virtual_disk.end())
-		{
-			_dbg_assert_(DVDINTERFACE, fileIter->first >= offset);
-			PadToAddress(fileIter->first, &offset, &length, &buffer);
-		}
+	m_open_files.push_front(std::move(open_file));
+	return &m_open_files.front();
+}
+
+bool CVolumeDirectory::ReadFile(size_t index, u64 file_offset, u64* offset, u64* length,
+	u8** buffer) const
+{
+	OpenFile* file = GetOpenFile(index);
+	if (!file)
+		return false;
+
+	FileMon::CheckFile(m_virtual_disk[index].path, file->size);
+
+	if (file_offset >= file->size)
+		return true;
+
+	u64 file_bytes = std::min(file->size - file_offset, *length);
+	if (file->mapped_file)
+	{
+		if (!file->mapped_file->Read(file_offset, file_bytes, *buffer))
+			return false;
+	}
+	else if (!file->file.Seek(file_offset, SEEK_SET) || !file->file.ReadBytes(*buffer, file_bytes))
+	{
+		file->file.Clear();
+		return false;
 	}
 
+	*length -= file_bytes;
+	*buffer += file_bytes;
+	*offset += file_bytes;
 	return true;
 }
 
@@ -341,6 +386,11 @@ void CVolumeDirectory::SetDOL(const std::string& dol)
 void CVolumeDirectory::BuildFST()
 {
 	m_fst_data.clear();
+	m_virtual_disk.clear();
+	{
+		std::lock_guard<std::mutex> lk(m_open_files_lock);
+		m_open_files.clear();
+	}
 
 	File::FSTEntry rootEntry = File::ScanDirectoryTree(m_root_directory, true);
 	u32 name_table_size = ComputeNameSize(rootEntry);
@@ -467,8 +517,10 @@ void CVolumeDirectory::WriteDirectory(const File::FSTEntry& parent_entry, u32* f
 			WriteEntryName(name_offset, entry.virtualName);
 
 			// write entry to virtual disk
-			_dbg_assert_(DVDINTERFACE, m_virtual_disk.find(*data_offset) == m_virtual_disk.end());
-			m_virtual_disk.emplace(*data_offset, entry.physicalName);
+			// Offsets only grow, so this keeps m_virtual_disk sorted.
+			_dbg_assert_(DVDINTERFACE,
+				m_virtual_disk.empty() || m_virtual_disk.back().offset < *data_offset);
+			m_virtual_disk.push_back({*data_offset, entry.physicalName});
 
 			// 4 byte aligned
 			*data_offset = Common::AlignUp(*data_offset + std::max<u64>(entry.size, 1ull), 0x8000ull);
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Volume.h"
 
 namespace File
@@ -74,6 +78,26 @@ private:
 
 	void SetDOL(const std::string& dol);
 
+	// A file of the directory placed on the virtual disc.
+	struct VirtualFile
+	{
+		u64 offset;
+		std::string path;
+	};
+
+	// Streaming a file issues many small reads, so the most recently read files are kept open
+	// (mapped if possible) along with their sizes instead of being reopened for each read.
+	struct OpenFile
+	{
+		size_t index;  // In m_virtual_disk
+		u64 size;
+		File::IOFile file;
+		std::unique_ptr<File::MappedFile> mapped_file;
+	};
+
+	OpenFile* GetOpenFile(size_t index) const;
+	bool ReadFile(size_t index, u64 file_offset, u64* offset, u64* length, u8** buffer) const;
+
 	// writing to read buffer
 	void WriteToBuffer(u64 source_start_address, u64 source_length, const u8* source, u64* address,
 		u64* length, u8** buffer) const;
@@ -90,7 +114,12 @@ private:
 
 	std::string m_root_directory;
 
-	std::map<u64, std::string> m_virtual_disk;
+	// Sorted by offset.
+	std::vector<VirtualFile> m_virtual_disk;
+
+	// Most recently used first.
+	mutable std::list<OpenFile> m_open_files;
+	mutable std::mutex m_open_files_lock;
 
 	bool m_is_wii;
 
@@ -149,6 +178,7 @@ private:
 	static constexpr u64 APPLOADER_ADDRESS = 0x2440;
 	static const size_t MAX_NAME_LENGTH = 0x3df;
 	static const size_t MAX_ID_LENGTH = 6;
+	static const size_t MAX_OPEN_FILES = 16;
 };
 
 }  // namespace
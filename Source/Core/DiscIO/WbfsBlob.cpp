@@ -16,6 +16,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/MappedFile.h"
 #include "Common/MsgHandler.h"
 #include "DiscIO/WbfsBlob.h"
 
@@ -28,7 +29,7 @@ static const u64 WII_DISC_HEADER_SIZE = 256;
 WbfsFileReader::WbfsFileReader(File::IOFile file, const std::string& path)
     : m_size(0), m_good(false)
 {
-  if (!AddFileToList(std::move(file)))
+  if (!AddFileToList(std::move(file), path))
     return;
   OpenAdditionalFiles(path);
   if (!ReadHeader())
@@ -67,18 +68,21 @@ void WbfsFileReader::OpenAdditionalFiles(const std::string& path)
       return;
     std::string current_path = path;
     current_path.back() = static_cast<char>('0' + m_files.size());
-    if (!AddFileToList(File::IOFile(current_path, "rb")))
+    if (!AddFileToList(File::IOFile(current_path, "rb"), current_path))
       return;
   }
 }
 
-bool WbfsFileReader::AddFileToList(File::IOFile file)
+bool WbfsFileReader::AddFileToList(File::IOFile file, const std::string& path)
 {
   if (!file.IsOpen())
     return false;
 
   const u64 file_size = file.GetSize();
-  m_files.emplace_back(std::move(file), m_size, file_size);
+  auto mapped_file = std::make_unique<File::MappedFile>();
+  if (!mapped_file->Open(path) || mapped_file->GetSize() != file_size)
+    mapped_file.reset();
+  m_files.emplace_back(std::move(file), std::move(mapped_file), m_size, file_size);
   m_size += file_size;
 
   return true;
@@ -117,15 +121,20 @@ bool WbfsFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
   while (nbytes)
   {
-    u64 read_size;
-    File::IOFile& data_file = SeekToCluster(offset, &read_size);
-    if (read_size == 0)
+    u64 file_offset, read_size;
+    file_entry* entry = FindCluster(offset, &file_offset, &read_size);
+    if (!entry)
       return false;
     read_size = std::min(read_size, nbytes);
 
-    if (!data_file.ReadBytes(out_ptr, read_size))
+    if (entry->mapped_file)
     {
-      data_file.Clear();
+      if (!entry->mapped_file->Read(file_offset, read_size, out_ptr))
+        return false;
+    }
+    else if (!entry->file.Seek(file_offset, SEEK_SET) || !entry->file.ReadBytes(out_ptr, read_size))
+    {
+      entry->file.Clear();
       return false;
     }
 
@@ -137,7 +146,8 @@ bool WbfsFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
   return true;
 }
 
-File::IOFile& WbfsFileReader::SeekToCluster(u64 offset, u64* available)
+WbfsFileReader::file_entry* WbfsFileReader::FindCluster(u64 offset, u64* file_offset,
+                                                         u64* available)
 {
   u64 base_cluster = (offset >> m_header.wbfs_sector_shift);
   if (base_cluster < m_blocks_per_disc)
@@ -150,24 +160,17 @@ File::IOFile& WbfsFileReader::SeekToCluster(u64 offset, u64* available)
     {
       if (final_address < (file_entry.base_address + file_entry.size))
       {
-        file_entry.file.Seek(final_address - file_entry.base_address, SEEK_SET);
-        if (available)
-        {
-          u64 till_end_of_file = file_entry.size - (final_address - file_entry.base_address);
-          u64 till_end_of_sector = m_wbfs_sector_size - cluster_offset;
-          *available = std::min(till_end_of_file, till_end_of_sector);
-        }
-
-        return file_entry.file;
+        *file_offset = final_address - file_entry.base_address;
+        u64 till_end_of_file = file_entry.size - *file_offset;
+        u64 till_end_of_sector = m_wbfs_sector_size - cluster_offset;
+        *available = std::min(till_end_of_file, till_end_of_sector);
+        return &file_entry;
       }
     }
   }
 
   PanicAlert("Read beyond end of disc");
-  if (available)
-    *available = 0;
-  m_files[0].file.Seek(0, SEEK_SET);
-  return m_files[0].file;
+  return nullptr;
 }
 
 std::unique_ptr<WbfsFileReader> WbfsFileReader::Create(File::IOFile file, const std::string& path)
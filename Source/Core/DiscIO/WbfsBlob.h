@@ -10,6 +10,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -36,23 +37,30 @@ private:
   WbfsFileReader(File::IOFile file, const std::string& path);
 
   void OpenAdditionalFiles(const std::string& path);
-  bool AddFileToList(File::IOFile file);
+  bool AddFileToList(File::IOFile file, const std::string& path);
   bool ReadHeader();
 
-  File::IOFile& SeekToCluster(u64 offset, u64* available);
   bool IsGood() { return m_good; }
   struct file_entry
   {
-    file_entry(File::IOFile file_, u64 base_address_, u64 size_)
-        : file(std::move(file_)), base_address(base_address_), size(size_)
+    file_entry(File::IOFile file_, std::unique_ptr<File::MappedFile> mapped_file_,
+               u64 base_address_, u64 size_)
+        : file(std::move(file_)), mapped_file(std::move(mapped_file_)),
+          base_address(base_address_), size(size_)
     {
     }
 
     File::IOFile file;
+    // Null if the file couldn't be mapped, in which case file is used instead.
+    std::unique_ptr<File::MappedFile> mapped_file;
     u64 base_address;
     u64 size;
   };
 
+  // Returns the file holding the disc offset and sets file_offset to where it is in that
+  // file and available to how many bytes can be read from there, or returns nullptr.
+  file_entry* FindCluster(u64 offset, u64* file_offset, u64* available);
+
   std::vector<file_entry> m_files;
 
   u64 m_size;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -372,15 +373,22 @@ void FifoPlayerDlg::OnSaveFile(wxCommandEvent& WXUNUSED(event))
 
 	if (file)
 	{
-		// Bring up a save file dialog. The location the user chooses will be assigned to this variable.
-		wxString path = wxSaveFileSelector(_("Dolphin FIFO"), "dff", wxEmptyString, this);
+		// Bring up a save file dialog. The second filter saves with per-frame compression, which
+		// older versions of Dolphin can't load.
+		wxFileDialog dialog(this, _("Save Dolphin FIFO"), wxEmptyString, wxEmptyString,
+			_("Dolphin FIFO Log (*.dff)") + "|*.dff|" +
+			_("Compressed Dolphin FIFO Log (*.dff)") + "|*.dff",
+			wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
 
 		// Has a valid file path
-		if (!path.empty())
+		if (dialog.ShowModal() == wxID_OK)
 		{
+			wxString path = dialog.GetPath();
+			bool compress = dialog.GetFilterIndex() == 1;
+
 			// Attempt to save the file to the path the user chose
 			wxBeginBusyCursor();
-			bool result = file->Save(WxStrToStr(path));
+			bool result = file->Save(WxStrToStr(path), compress);
 			wxEndBusyCursor();
 
 			// Wasn't able to save the file, shit's whack, yo.
@@ -455,7 +463,8 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
 	int const frame_idx = m_framesList->GetSelection();
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	const std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 
 	// TODO: Support searching through the last object... How do we know were the cmd data ends?
 	// TODO: Support searching for bit patterns
@@ -619,7 +628,9 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
 	if (frame_idx != -1 && object_idx != -1)
 	{
 		const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-		const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+		const std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr =
+			player.GetFile()->GetFrame(frame_idx);
+		const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 		const u8* objectdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx]];
 		const u8* objectdata_end = &fifo_frame.fifoData[frame.objectEnds[object_idx]];
 		u8* objectdata = (u8*)objectdata_start;
@@ -753,7 +764,8 @@ void FifoPlayerDlg::OnObjectCmdListSelectionChanged(wxCommandEvent& event)
 
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	const std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 	const u8* cmddata =
 		&fifo_frame.fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
 
@@ -905,7 +917,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
 	{
 		size_t fifoBytes = 0;
 		for (size_t i = 0; i < file->GetFrameCount(); ++i)
-			fifoBytes += file->GetFrame(i).fifoData.size();
+			fifoBytes += file->GetFrame(i)->fifoData.size();
 
 		return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
 	}
@@ -922,9 +934,9 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
 		size_t memBytes = 0;
 		for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
 		{
-			const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-			for (const auto& memUpdate : memUpdates)
-				memBytes += memUpdate.data.size();
+			const std::shared_ptr<const FifoFrameInfo> frame = file->GetFrame(frameNum);
+			for (const auto& memUpdate : frame->memoryUpdates)
+				memBytes += memUpdate.data->size();
 		}
 
 		return wxString::Format(_("%zu memory bytes"), memBytes);
@@ -51,6 +51,7 @@
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb_bt_base.h"
 #include "Core/Movie.h"
 #include "Core/NetPlayProto.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DolphinWX/Config/ConfigMain.h"
@@ -1636,6 +1637,8 @@ void CFrame::ParseHotkeys()
 		State::UndoLoadState();
 	if (IsHotkey(HK_UNDO_SAVE_STATE))
 		State::UndoSaveState();
+	if (IsHotkey(HK_REWIND))
+		Rewind::StepBack();
 #ifdef IS_PLAYBACK
 	// Slippi replay hotkeys and setup
 	if (IsHotkey(HK_HIDE_SEEKBAR))
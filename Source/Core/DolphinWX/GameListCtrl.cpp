@@ -1288,7 +1288,8 @@ void CGameListCtrl::CompressSelection(bool _compress)
 				all_good &=
 					DiscIO::CompressFileToBlob(iso->GetFileName(), OutputFileName,
 					(iso->GetPlatform() == DiscIO::Platform::WII_DISC) ? 1 : 0,
-						16384, &MultiCompressCB, &progress);
+						16384, &MultiCompressCB, &progress,
+						static_cast<DiscIO::GCZCodec>(SConfig::GetInstance().iGCZCodec));
 			}
 			else if (iso->IsCompressed() && !_compress)
 			{
@@ -1388,7 +1389,8 @@ void CGameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
 		else
 			all_good = DiscIO::CompressFileToBlob(
 				iso->GetFileName(), WxStrToStr(path),
-				(iso->GetPlatform() == DiscIO::Platform::WII_DISC) ? 1 : 0, 16384, &CompressCB, &dialog);
+				(iso->GetPlatform() == DiscIO::Platform::WII_DISC) ? 1 : 0, 16384, &CompressCB, &dialog,
+				static_cast<DiscIO::GCZCodec>(SConfig::GetInstance().iGCZCodec));
 	}
 
 	if (!all_good)
@@ -0,0 +1,113 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/Event.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+#include "VideoCommon/BatchWorkers.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace BatchWorkers
+{
+// Waking a worker costs a few microseconds, so only batches that take
+// noticeably longer than that to process are split.
+static const u32 PARALLEL_THRESHOLD = 8192;
+static const u32 MIN_CHUNK_SIZE = 2048;
+
+struct Worker
+{
+	std::thread thread;
+	Common::Event start;
+	u32 chunk;
+};
+
+static std::vector<std::unique_ptr<Worker>> s_workers;
+static std::atomic<bool> s_running;
+static std::atomic<u32> s_pending;
+static const std::function<void(u32)>* s_job;
+
+static void WorkerLoop(Worker* worker)
+{
+	Common::SetCurrentThreadName("Vertex Worker");
+	while (true)
+	{
+		worker->start.Wait();
+		if (!s_running.load())
+			return;
+		(*s_job)(worker->chunk);
+		s_pending.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void Init()
+{
+	Shutdown();
+	if (!g_ActiveConfig.bParallelVertexLoading)
+		return;
+
+	// Leave one core for the CPU thread and one for the GPU thread.
+	int count = std::min<int>(cpu_info.logical_cpu_count - 2, MAX_CHUNKS - 1);
+	if (count <= 0)
+		return;
+
+	s_running.store(true);
+	for (int i = 0; i < count; i++)
+	{
+		Worker* worker = new Worker();
+		worker->chunk = i + 1;
+		s_workers.emplace_back(worker);
+		worker->thread = std::thread(WorkerLoop, worker);
+	}
+	INFO_LOG(VIDEO, "Started %d vertex workers", count);
+}
+
+void Shutdown()
+{
+	if (s_workers.empty())
+		return;
+
+	s_running.store(false);
+	for (auto& worker : s_workers)
+	{
+		worker->start.Set();
+		worker->thread.join();
+	}
+	s_workers.clear();
+}
+
+u32 GetChunkCount(u32 item_count)
+{
+	if (s_workers.empty() || item_count < PARALLEL_THRESHOLD)
+		return 1;
+	return std::min<u32>(static_cast<u32>(s_workers.size()) + 1, item_count / MIN_CHUNK_SIZE);
+}
+
+void Run(u32 chunk_count, const std::function<void(u32)>& job)
+{
+	if (chunk_count <= 1)
+	{
+		job(0);
+		return;
+	}
+
+	s_job = &job;
+	s_pending.store(chunk_count - 1, std::memory_order_relaxed);
+	for (u32 i = 1; i < chunk_count; i++)
+		s_workers[i - 1]->start.Set();
+
+	job(0);
+
+	// The workers got their chunks at the same time as we started ours,
+	// so they are usually done by now.
+	while (s_pending.load(std::memory_order_acquire) != 0)
+		Common::YieldCPU();
+}
+}
@@ -0,0 +1,29 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+
+#include "Common/CommonTypes.h"
+
+// Small fork/join helper used to split big draw batches across a few threads.
+// The GPU thread always runs chunk 0 itself and only hands the remaining
+// chunks to the workers, so a batch never waits on a sleeping thread to start.
+namespace BatchWorkers
+{
+// Upper bound of chunks a single Run() can be split into.
+static const u32 MAX_CHUNKS = 4;
+
+void Init();
+void Shutdown();
+
+// Number of chunks a batch of item_count items should be split into.
+// Returns 1 when the workers are disabled or the batch is too small to be worth it.
+u32 GetChunkCount(u32 item_count);
+
+// Calls job(chunk) for every chunk in [0, chunk_count) and returns once all of them are done.
+// Jobs must only touch disjoint parts of their output.
+void Run(u32 chunk_count, const std::function<void(u32)>& job);
+}
@@ -2,10 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
+#include "VideoCommon/BatchWorkers.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
@@ -15,7 +17,8 @@ u16 *IndexGenerator::index_buffer_current;
 u16 *IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
 
-static void(*primitive_table[8])(u32);
+static u16*(*primitive_table[8])(u16*, u32, u32, u32, u32);
+static u32 indices_per_unit[8];
 
 void IndexGenerator::Init()
 {
@@ -31,6 +34,15 @@ void IndexGenerator::Init()
 	primitive_table[GX_DRAW_LINES] = &IndexGenerator::AddLineList;
 	primitive_table[GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip;
 	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPoints;
+
+	indices_per_unit[GX_DRAW_QUADS] = 6;
+	indices_per_unit[GX_DRAW_QUADS_2] = 6;
+	indices_per_unit[GX_DRAW_TRIANGLES] = 3;
+	indices_per_unit[GX_DRAW_TRIANGLE_STRIP] = 3;
+	indices_per_unit[GX_DRAW_TRIANGLE_FAN] = 3;
+	indices_per_unit[GX_DRAW_LINES] = 2;
+	indices_per_unit[GX_DRAW_LINE_STRIP] = 2;
+	indices_per_unit[GX_DRAW_POINTS] = 1;
 }
 
 void IndexGenerator::Start(u16* Indexptr)
@@ -40,9 +52,55 @@ void IndexGenerator::Start(u16* Indexptr)
 	base_index = 0;
 }
 
+u32 IndexGenerator::GetUnitCount(int primitive, u32 numVerts)
+{
+	switch (primitive)
+	{
+	case GX_DRAW_QUADS:
+	case GX_DRAW_QUADS_2:
+		// A trailing group of three vertices is drawn as a single triangle.
+		return numVerts / 4 + ((numVerts & 3) == 3 ? 1 : 0);
+	case GX_DRAW_TRIANGLES:
+		return numVerts / 3;
+	case GX_DRAW_TRIANGLE_STRIP:
+	case GX_DRAW_TRIANGLE_FAN:
+		return numVerts > 2 ? numVerts - 2 : 0;
+	case GX_DRAW_LINES:
+		return numVerts / 2;
+	case GX_DRAW_LINE_STRIP:
+		return numVerts > 1 ? numVerts - 1 : 0;
+	default:
+		return numVerts;
+	}
+}
+
 void IndexGenerator::AddIndices(int primitive, u32 numVerts)
 {
-	primitive_table[primitive](numVerts);
+	const u32 units = GetUnitCount(primitive, numVerts);
+	const u32 chunks = BatchWorkers::GetChunkCount(units);
+	u16*(*generate)(u16*, u32, u32, u32, u32) = primitive_table[primitive];
+	if (chunks > 1)
+	{
+		// Units have a fixed size, so every chunk knows where its output starts.
+		u16* const ptr = index_buffer_current;
+		const u32 base = base_index;
+		const u32 unit_size = indices_per_unit[primitive];
+		const u32 units_per_chunk = (units + chunks - 1) / chunks;
+		u16* end = ptr;
+		BatchWorkers::Run(chunks, [&](u32 chunk)
+		{
+			u32 first = std::min(chunk * units_per_chunk, units);
+			u32 last = std::min(first + units_per_chunk, units);
+			u16* chunk_end = generate(ptr + first * unit_size, base, numVerts, first, last);
+			if (first < last && last == units)
+				end = chunk_end;
+		});
+		index_buffer_current = end;
+	}
+	else
+	{
+		index_buffer_current = generate(index_buffer_current, base_index, numVerts, 0, units);
+	}
 	base_index += numVerts;
 }
 
@@ -55,26 +113,24 @@ __forceinline u16* IndexGenerator::WriteTriangle(u16* ptr, u32 index1, u32 index
 	return ptr;
 }
 
-void IndexGenerator::AddList(u32 const numVerts)
+u16* IndexGenerator::AddList(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index + 2;
-	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	u32 i = base + first * 3 + 2;
+	u32 top = base + last * 3 + 2;
 	while (i < top)
 	{
 		ptr = WriteTriangle(ptr, i - 2, i - 1, i);
 		i += 3;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
-void IndexGenerator::AddStrip(u32 const numVerts)
+u16* IndexGenerator::AddStrip(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u16* ptr = index_buffer_current;
-	u32 top = (base_index + numVerts);
-	u32 a = base_index;
+	u32 a = base + first;
 	u32 i = a + 2;
-	u32 wind = 1;
+	u32 top = base + last + 2;
+	u32 wind = (first & 1) ^ 1;
 	while (i < top)
 	{
 		u32 b = i - wind;
@@ -88,7 +144,7 @@ void IndexGenerator::AddStrip(u32 const numVerts)
 		++i;
 		++a;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
 /**
@@ -110,18 +166,17 @@ void IndexGenerator::AddStrip(u32 const numVerts)
  * so we use 6 indices for 3 triangles
  */
 
-void IndexGenerator::AddFan(u32 numVerts)
+u16* IndexGenerator::AddFan(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index + 2;
-	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	u32 i = base + first + 2;
+	u32 top = base + last + 2;
 
 	while (i < top)
 	{
-		ptr = WriteTriangle(ptr, base_index, i - 1, i);
+		ptr = WriteTriangle(ptr, base, i - 1, i);
 		++i;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
 /*
@@ -141,11 +196,11 @@ void IndexGenerator::AddFan(u32 numVerts)
  * A simple triangle has to be rendered for three vertices.
  * ZWW do this for sun rays
  */
-void IndexGenerator::AddQuads(u32 numVerts)
+u16* IndexGenerator::AddQuads(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index + 3;
-	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	const u32 quads = numVerts / 4;
+	u32 i = base + first * 4 + 3;
+	u32 top = base + std::min(last, quads) * 4 + 3;
 	while (i < top)
 	{
 		ptr = WriteTriangle(ptr, i - 3, i - 2, i - 1);
@@ -154,60 +209,58 @@ void IndexGenerator::AddQuads(u32 numVerts)
 	}
 
 	// three vertices remaining, so render a triangle
-	if (i == top)
+	if (last > quads)
 	{
+		top = base + numVerts;
 		ptr = WriteTriangle(ptr, top - 3, top - 2, top - 1);
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
-void IndexGenerator::AddQuads_nonstandard(u32 numVerts)
+u16* IndexGenerator::AddQuads_nonstandard(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
 	WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
-	AddQuads(numVerts);
+	return AddQuads(ptr, base, numVerts, first, last);
 }
 
 // Lines
-void IndexGenerator::AddLineList(u32 numVerts)
+u16* IndexGenerator::AddLineList(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index + 1;
-	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	u32 i = base + first * 2 + 1;
+	u32 top = base + last * 2 + 1;
 	while (i < top)
 	{
 		*ptr++ = i - 1;
 		*ptr++ = i;
 		i += 2;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
 // shouldn't be used as strips as LineLists are much more common
 // so converting them to lists
-void IndexGenerator::AddLineStrip(u32 numVerts)
+u16* IndexGenerator::AddLineStrip(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index + 1;
-	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	u32 i = base + first + 1;
+	u32 top = base + last + 1;
 	while (i < top)
 	{
 		*ptr++ = i - 1;
 		*ptr++ = i;
 		++i;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
 
 // Points
-void IndexGenerator::AddPoints(u32 numVerts)
+u16* IndexGenerator::AddPoints(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last)
 {
-	u32 i = base_index;
-	u32 top = (base_index + numVerts);
-	u16 *ptr = index_buffer_current;
+	u32 i = base + first;
+	u32 top = base + last;
 	while (i < top)
 	{
 		*ptr++ = i;
 		++i;
 	}
-	index_buffer_current = ptr;
+	return ptr;
 }
@@ -36,19 +36,25 @@ public:
 		return BASEIptr;
 	}
 private:
+	// Every primitive type is generated as a sequence of independent units
+	// (a triangle, a quad, a line or a point) with a fixed number of indices each,
+	// so any range of units can be written without looking at its neighbours.
+	static u32 GetUnitCount(int primitive, u32 numVerts);
+
+	// Each of these writes the units [first, last) of a batch to ptr and returns the new end.
 	// Triangles
-	static void AddList(u32 numVerts);
-	static void AddStrip(u32 numVerts);
-	static void AddFan(u32 numVerts);
-	static void AddQuads(u32 numVerts);
-	static void AddQuads_nonstandard(u32 numVerts);
+	static u16* AddList(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
+	static u16* AddStrip(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
+	static u16* AddFan(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
+	static u16* AddQuads(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
+	static u16* AddQuads_nonstandard(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
 
 	// Lines
-	static void AddLineList(u32 numVerts);
-	static void AddLineStrip(u32 numVerts);
+	static u16* AddLineList(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
+	static u16* AddLineStrip(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
 
 	// Points
-	static void AddPoints(u32 numVerts);
+	static u16* AddPoints(u16* ptr, u32 base, u32 numVerts, u32 first, u32 last);
 
 	static u16* WriteTriangle(u16 *ptr, u32 index1, u32 index2, u32 index3);
 
@@ -111,6 +111,14 @@ u32 VertexLoaderUID::GetElement(u32 idx) const
 	return vid[idx];
 }
 
+void VertexLoaderUID::GetVertexFormat(TVtxDesc& VtxDesc, VAT& vat) const
+{
+	VtxDesc.Hex = (((u64)vid[0]) << 1) | (vid[2] >> 31);
+	vat.g0.Hex = vid[1];
+	vat.g1.Hex = vid[2] & 0x7FFFFFFFu;
+	vat.g2.Hex = vid[3];
+}
+
 u64 VertexLoaderUID::CalculateHash()
 {
 	u64 h = -1;
@@ -29,12 +29,17 @@ class VertexLoaderUID
 	u64 hash;
 	size_t platformhash;
 public:
+	VertexLoaderUID() {}
 	VertexLoaderUID(const TVtxDesc& VtxDesc, const VAT& vat);
 	bool operator < (const VertexLoaderUID &other) const;
 	bool operator == (const VertexLoaderUID& rh) const;
 	u64 GetHash() const;
 	size_t GetplatformHash() const;
 	u32 GetElement(u32 idx) const;
+	// Rebuilds a vertex format that maps to this uid.
+	// Frac bits are not part of the uid, so they come back as zero. That's only the format
+	// the game used for loaders which read the Frac fields at run time.
+	void GetVertexFormat(TVtxDesc& VtxDesc, VAT& vat) const;
 private:
 	u64 CalculateHash();
 };
@@ -78,6 +83,19 @@ public:
 	}
 	virtual s32 RunVertices(const VertexLoaderParameters &parameters) = 0;
 
+	// Loaders whose code only reads shared state can convert disjoint parts of a batch
+	// from several threads. PrepareRun() is called once on the GPU thread, then
+	// RunRange() for every part; it returns the number of vertices written to dst.
+	virtual bool SupportsParallelRun() const
+	{
+		return false;
+	}
+	virtual void PrepareRun(const VertexLoaderParameters &parameters) {}
+	virtual s32 RunRange(const u8* src, u8* dst, int count)
+	{
+		return 0;
+	}
+
 	virtual bool IsInitialized() = 0;
 
 	// For debugging / profiling
@@ -3,6 +3,9 @@
 // Refer to the license.txt file included.
 // Modified for Ishiiruka by Tino
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -11,9 +14,12 @@
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
+#include "Common/FileUtil.h"
+#include "Common/LinearDiskCache.h"
 #include "Common/ThreadPool.h"
 #include "Common/StringUtil.h"
 
+#include "VideoCommon/BatchWorkers.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -30,6 +36,10 @@ typedef std::unordered_map<VertexLoaderUID, std::unique_ptr<VertexLoaderBase>> V
 namespace VertexLoaderManager
 {
 static VertexLoaderMap s_vertex_loader_map;
+// Every loader a game has ever used, so the next boot can build them before the first draw.
+// The value is the VAT of the first draw which used the loader, as the uid doesn't have the
+// Frac fields and some loaders (ARM64) bake them into their code.
+static LinearDiskCache<VertexLoaderUID, u8> s_vertex_loader_disk_cache;
 static NativeVertexFormatMap s_native_vertex_map;
 static NativeVertexFormat* s_current_vtx_fmt;
 u32 g_current_components;
@@ -184,16 +194,51 @@ void AppendListToString(std::string *dest)
 	}
 }
 
+class VertexLoaderCacheInserter : public LinearDiskCacheReader<VertexLoaderUID, u8>
+{
+public:
+	void Read(const VertexLoaderUID& key, const u8* value, u32 value_size) override
+	{
+		// Entries written before the VAT was stored can't be built the way the game used them.
+		if (value_size != sizeof(VAT) || s_vertex_loader_map.find(key) != s_vertex_loader_map.end())
+			return;
+		TVtxDesc vtx_desc;
+		VAT vtx_attr;
+		key.GetVertexFormat(vtx_desc, vtx_attr);
+		memcpy(&vtx_attr, value, sizeof(VAT));
+		// Native formats need the backend vertex manager, which does not exist yet.
+		// They are resolved the first time the loader is looked up.
+		s_vertex_loader_map[key] = VertexLoaderBase::CreateVertexLoader(vtx_desc, vtx_attr);
+		INCSTAT(stats.numVertexLoaders);
+	}
+};
+
 void Init()
 {
 	MarkAllDirty();
 	for (VertexLoaderBase*& vertexLoader : g_main_cp_state.vertex_loaders)
 		vertexLoader = nullptr;
+	BatchWorkers::Init();
 	last_game_code = SConfig::GetInstance().m_strGameID;
+	if (last_game_code.empty())
+		return;
+
+	if (!File::Exists(File::GetUserPath(D_SHADERCACHE_IDX)))
+		File::CreateDir(File::GetUserPath(D_SHADERCACHE_IDX).c_str());
+
+	std::string cache_filename = StringFromFormat("%sIVL-%s-loaders.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
+		last_game_code.c_str());
+	VertexLoaderCacheInserter inserter;
+	u32 loader_count = s_vertex_loader_disk_cache.OpenAndRead(cache_filename, inserter);
+	if (loader_count > 0)
+		INFO_LOG(VIDEO, "Warmed up %u vertex loaders for %s", loader_count, last_game_code.c_str());
 }
 
 void Shutdown()
 {
+	BatchWorkers::Shutdown();
+	s_vertex_loader_disk_cache.Sync();
+	s_vertex_loader_disk_cache.Close();
 	if (s_vertex_loader_map.size() > 0 && g_ActiveConfig.bDumpVertexLoaders)
 		DumpLoadersCode();
 	s_vertex_loader_map.clear();
@@ -239,6 +284,16 @@ void MarkAllDirty()
 	g_preprocess_cp_state.bases_dirty = true;
 }
 
+static void ResolveNativeVertexFormat(VertexLoaderBase* loader)
+{
+	loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
+	VertexLoaderBase * fallback = loader->GetFallback();
+	if (fallback)
+	{
+		fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
+	}
+}
+
 inline VertexLoaderBase *GetOrAddLoader(const TVtxDesc &VtxDesc, const VAT &VtxAttr)
 {
 	VertexLoaderUID uid(VtxDesc, VtxAttr);
@@ -247,16 +302,16 @@ inline VertexLoaderBase *GetOrAddLoader(const TVtxDesc &VtxDesc, const VAT &VtxA
 	{
 		s_vertex_loader_map[uid] = VertexLoaderBase::CreateVertexLoader(VtxDesc, VtxAttr);
 		VertexLoaderBase* loader = s_vertex_loader_map[uid].get();
-		loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
-		VertexLoaderBase * fallback = loader->GetFallback();
-		if (fallback)
-		{
-			fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
-		}
+		ResolveNativeVertexFormat(loader);
+		s_vertex_loader_disk_cache.Append(uid, (const u8*)&VtxAttr, sizeof(VAT));
 		INCSTAT(stats.numVertexLoaders);
 		return loader;
 	}
-	return iter->second.get();
+	VertexLoaderBase* loader = iter->second.get();
+	// Loaders warmed up from the disk cache don't have their native format yet.
+	if (!loader->m_native_vertex_format)
+		ResolveNativeVertexFormat(loader);
+	return loader;
 }
 
 void GetVertexSizeAndComponents(const VertexLoaderParameters &parameters, u32 &vertexsize, u32 &components)
@@ -275,6 +330,40 @@ inline void UpdateLoader(const VertexLoaderParameters &parameters)
 	g_main_cp_state.last_id = parameters.vtx_attr_group;
 }
 
+// Splits a big batch into contiguous parts converted by the vertex workers.
+// Vertices with an invalid position index are skipped by the loader, so a part can
+// come back shorter than it started and the following parts are moved down to close the gap.
+static s32 RunVerticesParallel(VertexLoaderBase* loader, const VertexLoaderParameters &parameters, u32 chunks)
+{
+	const int vertices_per_chunk = (parameters.count + chunks - 1) / chunks;
+	std::array<s32, BatchWorkers::MAX_CHUNKS> written = {};
+	loader->PrepareRun(parameters);
+	BatchWorkers::Run(chunks, [&](u32 chunk)
+	{
+		const int first = chunk * vertices_per_chunk;
+		const int count = std::min(vertices_per_chunk, parameters.count - first);
+		if (count > 0)
+		{
+			written[chunk] = loader->RunRange(parameters.source + first * loader->m_VertexSize,
+				parameters.destination + first * loader->m_native_stride, count);
+		}
+	});
+
+	s32 total = written[0];
+	for (u32 chunk = 1; chunk < chunks; chunk++)
+	{
+		const s32 first = chunk * vertices_per_chunk;
+		if (total != first && written[chunk] > 0)
+		{
+			memmove(parameters.destination + total * loader->m_native_stride,
+				parameters.destination + first * loader->m_native_stride,
+				written[chunk] * loader->m_native_stride);
+		}
+		total += written[chunk];
+	}
+	return total;
+}
+
 bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
 {
 	if (parameters.needloaderrefresh)
@@ -305,7 +394,12 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	g_current_components = loader->m_native_components;
 	g_vertex_manager->PrepareForAdditionalData(parameters.primitive, parameters.count, loader->m_native_stride);
 	parameters.destination = g_vertex_manager->GetCurrentBufferPointer();
-	s32 finalcount = loader->RunVertices(parameters);
+	s32 finalcount;
+	u32 chunks = BatchWorkers::GetChunkCount(parameters.count);
+	if (chunks > 1 && loader->SupportsParallelRun())
+		finalcount = RunVerticesParallel(loader, parameters, chunks);
+	else
+		finalcount = loader->RunVertices(parameters);
 	writesize = loader->m_native_stride * finalcount;
 	IndexGenerator::AddIndices(parameters.primitive, finalcount);
 	ADDSTAT(stats.thisFrame.numPrims, finalcount);
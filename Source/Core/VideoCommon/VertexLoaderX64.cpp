@@ -25,6 +25,8 @@ static const X64Reg count_reg = R10;
 static const X64Reg skipped_reg = R11;
 static const u32 MASKINDEXED = INDEX8 & INDEX16;
 static const X64Reg base_reg = RBX;
+// The pair loop keeps the converted attributes of both vertices in these until they are stored.
+static const X64Reg pair_result_regs[] = { YMM12, YMM13, YMM14, YMM15 };
 
 static const u8* memory_base_ptr = (u8*)&g_main_cp_state.array_strides;
 
@@ -49,12 +51,48 @@ static __m128 scale_factors[13] = {
 	_mm_set_ps1(0.0f)
 };
 
+static const __m128i shuffle_lut[5][3] = {
+	{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
+	{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
+	_mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
+	{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
+	{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
+	_mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
+	{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
+	_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
+	_mm_set_epi32(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
+};
+
+// The same shuffles repeated in both 128-bit lanes, for VPSHUFB on two vertices at once.
+static const struct ShuffleLut256
+{
+	ShuffleLut256()
+	{
+		for (int format = 0; format < 5; format++)
+		{
+			for (int count = 0; count < 3; count++)
+			{
+				lanes[format][count][0] = shuffle_lut[format][count];
+				lanes[format][count][1] = shuffle_lut[format][count];
+			}
+		}
+	}
+	__m128i lanes[5][3][2];
+} shuffle_lut_256;
+
 VertexLoaderX64::VertexLoaderX64(const TVtxDesc& vtx_desc, const VAT& vtx_att) : VertexLoaderBase(vtx_desc, vtx_att)
 {
 	if (!IsInitialized())
 		return;
 
-	AllocCodeSpace(1024, false);
+	m_use_avx2 = CanUseAVX2();
+	AllocCodeSpace(m_use_avx2 ? 4096 : 1024, false);
 	ClearCodeSpace();
 	GenerateVertexLoader();
 	WriteProtect();
@@ -89,23 +127,6 @@ OpArg VertexLoaderX64::GetVertexAddr(int array, u64 attribute)
 
 int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, X64Reg scaling_register)
 {
-	static const __m128i shuffle_lut[5][3] = {
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
-		_mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
-		_mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
-		{ _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
-		_mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
-		_mm_set_epi32(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
-	};
 
 	X64Reg coords = XMM0;
 	int elem_size = 1 << (format / 2);
@@ -117,6 +138,8 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
 	native_format->offset = m_dst_ofs;
 	native_format->type = FORMAT_FLOAT;
 
+	m_paired_attributes.push_back({ false, data, m_dst_ofs, format, count_in, count_out, dequantize, scaling_register });
+
 	m_dst_ofs += sizeof(float) * count_out;
 
 	if (attribute == DIRECT)
@@ -247,6 +270,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
 
 void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 {
+	m_paired_attributes.push_back({ true, data, m_dst_ofs, format, 0, 0, false, INVALID_REG });
 	int load_bytes = 0;
 	switch (format)
 	{
@@ -370,6 +394,11 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 void VertexLoaderX64::GenerateVertexLoader()
 {
 	BitSet32 regs = { src_reg, dst_reg, scratch1, scratch2, scratch3, count_reg, skipped_reg, base_reg };
+	if (m_use_avx2)
+	{
+		for (X64Reg reg : pair_result_regs)
+			regs[16 + reg] = true;
+	}
 	regs &= ABI_ALL_CALLEE_SAVED;
 	ABI_PushRegistersAndAdjustStack(regs, 0);
 
@@ -383,11 +412,11 @@ void VertexLoaderX64::GenerateVertexLoader()
 	// Load Contants into registers outside the main loop to reduce memory overhead
 	if (m_VtxAttr.PosFormat != FORMAT_FLOAT && m_VtxAttr.ByteDequant)
 	{
-		MOVAPD(XMM2, MPIC(&scale_factors[0]));
+		LoadScaleFactor(XMM2, &scale_factors[0]);
 	}
 	if (m_VtxDesc.Normal)
 	{
-		MOVAPD(XMM3, MPIC(&scale_factors[m_VtxAttr.NormalFormat + 1]));
+		LoadScaleFactor(XMM3, &scale_factors[m_VtxAttr.NormalFormat + 1]);
 	}
 
 	const u64 tc[8] = {
@@ -405,7 +434,7 @@ void VertexLoaderX64::GenerateVertexLoader()
 		{
 			if (tc[i] && m_VtxAttr.texCoord[i].Format != FORMAT_FLOAT)
 			{
-				MOVAPD(treg[i], MPIC(&scale_factors[5 + i]));
+				LoadScaleFactor(treg[i], &scale_factors[5 + i]);
 			}
 		}
 	}
@@ -413,6 +442,12 @@ void VertexLoaderX64::GenerateVertexLoader()
 	if (m_VtxDesc.Position & MASKINDEXED)
 		XOR(32, R(skipped_reg), R(skipped_reg));
 
+	// The pair loop needs the final vertex layout, so it is emitted after the single vertex
+	// loop and falls back into it for the last odd vertex.
+	FixupBranch to_pair_loop;
+	if (m_use_avx2)
+		to_pair_loop = J(true);
+
 	const u8* loop_start = GetCodePtr();
 
 	if (m_VtxDesc.PosMatIdx)
@@ -514,6 +549,7 @@ void VertexLoaderX64::GenerateVertexLoader()
 	}
 	AND(32, R(scratch1), Imm8(0x3F));
 	MOV(32, MDisp(dst_reg, m_dst_ofs), R(scratch1));
+	m_posmtx_ofs = m_dst_ofs;
 	m_native_vtx_decl.posmtx.components = 4;
 	m_native_vtx_decl.posmtx.enable = true;
 	m_native_vtx_decl.posmtx.offset = m_dst_ofs;
@@ -529,6 +565,7 @@ void VertexLoaderX64::GenerateVertexLoader()
 	SUB(32, R(count_reg), Imm8(1));
 	J_CC(CC_NZ, loop_start);
 
+	const u8* done = GetCodePtr();
 	// Get the original count.
 	POP(32, R(ABI_RETURN));
 
@@ -550,6 +587,179 @@ void VertexLoaderX64::GenerateVertexLoader()
 	m_native_stride = m_dst_ofs;
 	m_VertexSize = m_src_ofs;
 	m_native_vtx_decl.stride = m_native_stride;
+
+	if (m_use_avx2)
+	{
+		SetJumpTarget(to_pair_loop);
+		GeneratePairLoop(loop_start, done);
+	}
+	m_paired_attributes.clear();
+}
+
+bool VertexLoaderX64::CanUseAVX2() const
+{
+	if (!cpu_info.bAVX2)
+		return false;
+
+	// Indexed attributes need the skip logic and a per vertex array lookup, and texture matrix
+	// indices are converted with scalar SSE, so leave those to the single vertex loop.
+	const u64 attributes[12] = {
+		m_VtxDesc.Position, m_VtxDesc.Normal, m_VtxDesc.Color0, m_VtxDesc.Color1,
+		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
+		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
+	};
+	size_t vector_attributes = 0;
+	for (int i = 0; i < 12; i++)
+	{
+		if (attributes[i] & MASKINDEXED)
+			return false;
+		// Colors are converted in GPRs.
+		if (attributes[i] && (i < ARRAY_COLOR || i > ARRAY_COLOR2))
+			vector_attributes += (i == ARRAY_NORMAL && m_VtxAttr.NormalElements) ? 3 : 1;
+	}
+	if (vector_attributes > ArraySize(pair_result_regs))
+		return false;
+	const u64 texmtxidx_mask = 0x1FEull;
+	return (m_VtxDesc.Hex & texmtxidx_mask) == 0;
+}
+
+void VertexLoaderX64::LoadScaleFactor(X64Reg reg, const void* scale)
+{
+	// The pair loop multiplies full YMM registers, so broadcast to both lanes.
+	// The low lane is what MOVAPD would have loaded.
+	if (m_use_avx2)
+		VBROADCASTSS(reg, MPIC(scale));
+	else
+		MOVAPD(reg, MPIC(scale));
+}
+
+void VertexLoaderX64::ConvertVertexPair(const PairedAttribute& attribute, X64Reg result)
+{
+	int elem_size = 1 << (attribute.format / 2);
+	int load_bytes = elem_size * attribute.count_in;
+	OpArg data = attribute.data;
+	data.AddMemOffset(m_src_ofs);
+
+	// Broadcast loads only use the load ports, which keeps the shuffle port free for VPSHUFB.
+	// They read exactly as many bytes as the single vertex loop does.
+	if (load_bytes > 8)
+	{
+		VMOVDQU(result, attribute.data);
+		VBROADCASTI128(YMM0, data);
+	}
+	else if (load_bytes > 4)
+	{
+		VMOVQ_xmm(result, attribute.data);
+		VPBROADCASTQ(YMM0, data);
+	}
+	else
+	{
+		VMOVD_xmm(result, attribute.data);
+		VPBROADCASTD(YMM0, data);
+	}
+	VPBLENDD(result, result, R(YMM0), 0xF0);
+	VPSHUFB(result, result, MPIC(&shuffle_lut_256.lanes[attribute.format][attribute.count_in - 1]));
+
+	// Sign-extend.
+	if (attribute.format == FORMAT_BYTE)
+		VPSRAD(result, result, 24);
+	if (attribute.format == FORMAT_SHORT)
+		VPSRAD(result, result, 16);
+
+	if (attribute.format != FORMAT_FLOAT)
+	{
+		VCVTDQ2PS(result, R(result));
+
+		if (attribute.dequantize)
+			VMULPS(result, result, R(attribute.scaling_register));
+	}
+}
+
+void VertexLoaderX64::StoreVertexPair(const PairedAttribute& attribute, X64Reg result, int vertex)
+{
+	OpArg dest = MDisp(dst_reg, attribute.dst_ofs + vertex * m_dst_ofs);
+	X64Reg coords = result;
+	if (vertex)
+	{
+		if (attribute.count_out == 3)
+		{
+			// Same 4 byte overlap into the next attribute as the single vertex loop.
+			VEXTRACTI128(dest, result, 1);
+			return;
+		}
+		VEXTRACTI128(R(XMM0), result, 1);
+		coords = XMM0;
+	}
+
+	switch (attribute.count_out)
+	{
+	case 1: VMOVSS(dest, coords); break;
+	case 2: VMOVLPS(dest, coords); break;
+	case 3: VMOVUPS(dest, coords); break;
+	}
+}
+
+void VertexLoaderX64::ReadColorPair(const PairedAttribute& attribute, int vertex)
+{
+	// Colors are converted in GPRs, so this is just the scalar code at the second vertex's offsets.
+	const u32 src_size = m_src_ofs;
+	const u32 dst_size = m_dst_ofs;
+	OpArg data = attribute.data;
+	data.AddMemOffset(vertex * src_size);
+	m_dst_ofs = attribute.dst_ofs + vertex * dst_size;
+	ReadColor(data, DIRECT, attribute.format);
+	m_src_ofs = src_size;
+	m_dst_ofs = dst_size;
+}
+
+void VertexLoaderX64::GeneratePairLoop(const u8* single_loop, const u8* done)
+{
+	// ReadColor() records again while replaying, keep the list we iterate separate.
+	const std::vector<PairedAttribute> attributes = std::move(m_paired_attributes);
+
+	const u8* pair_loop = GetCodePtr();
+	CMP(32, R(count_reg), Imm8(2));
+	FixupBranch tail = J_CC(CC_B, true);
+
+	// Convert both vertices first, then write them out one after the other. Interleaving the
+	// stores of the two vertices defeats store merging and ends up slower than the SSE loop.
+	size_t result = 0;
+	for (const PairedAttribute& attribute : attributes)
+	{
+		if (!attribute.is_color)
+			ConvertVertexPair(attribute, pair_result_regs[result++]);
+	}
+
+	for (int vertex = 0; vertex < 2; vertex++)
+	{
+		result = 0;
+		for (const PairedAttribute& attribute : attributes)
+		{
+			if (attribute.is_color)
+				ReadColorPair(attribute, vertex);
+			else
+				StoreVertexPair(attribute, pair_result_regs[result++], vertex);
+		}
+
+		if (m_VtxDesc.PosMatIdx)
+			MOVZX(32, 8, scratch1, MDisp(src_reg, vertex * m_src_ofs));
+		else
+			MOV(32, R(scratch1), MPIC(&g_main_cp_state.matrix_index_a));
+		AND(32, R(scratch1), Imm8(0x3F));
+		MOV(32, MDisp(dst_reg, m_posmtx_ofs + vertex * m_dst_ofs), R(scratch1));
+	}
+
+	ADD(64, R(dst_reg), Imm32(2 * m_dst_ofs));
+	ADD(64, R(src_reg), Imm32(2 * m_src_ofs));
+	SUB(32, R(count_reg), Imm8(2));
+	JMP(pair_loop, true);
+
+	// Leave the upper YMM halves clean before running legacy SSE code or returning.
+	SetJumpTarget(tail);
+	VZEROUPPER();
+	TEST(32, R(count_reg), R(count_reg));
+	J_CC(CC_NZ, single_loop);
+	JMP(done, true);
 }
 
 bool VertexLoaderX64::EnvironmentIsSupported()
@@ -557,7 +767,7 @@ bool VertexLoaderX64::EnvironmentIsSupported()
 	return g_ActiveConfig.iBBoxMode == BBoxGPU || !BoundingBox::active;
 }
 
-int VertexLoaderX64::RunVertices(const VertexLoaderParameters &parameters)
+void VertexLoaderX64::PrepareRun(const VertexLoaderParameters &parameters)
 {
 	const VAT &vat = *parameters.VtxAttr;
 	scale_factors[0] = _mm_set_ps1(fractionTable[vat.g0.PosFrac]);
@@ -573,5 +783,16 @@ int VertexLoaderX64::RunVertices(const VertexLoaderParameters &parameters)
 		scale_factors[12] = _mm_set_ps1(fractionTable[vat.g2.Tex7Frac]);
 	}
 	m_numLoadedVertices += parameters.count;
-	return ((int(*)(const u8* src, u8* dst, int count, const void*))region)(parameters.source, parameters.destination, parameters.count, memory_base_ptr);
+}
+
+// The generated code only writes to dst, so this is safe to call from any thread once PrepareRun() is done.
+s32 VertexLoaderX64::RunRange(const u8* src, u8* dst, int count)
+{
+	return ((int(*)(const u8* src, u8* dst, int count, const void*))region)(src, dst, count, memory_base_ptr);
+}
+
+int VertexLoaderX64::RunVertices(const VertexLoaderParameters &parameters)
+{
+	PrepareRun(parameters);
+	return RunRange(parameters.source, parameters.destination, parameters.count);
 }
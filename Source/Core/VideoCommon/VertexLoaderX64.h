@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "Common/x64Emitter.h"
 #include "VideoCommon/VertexLoaderBase.h"
 
@@ -12,13 +14,44 @@ protected:
 		return true;
 	}
 	int RunVertices(const VertexLoaderParameters &parameters) override;
+	bool SupportsParallelRun() const override
+	{
+		return true;
+	}
+	void PrepareRun(const VertexLoaderParameters &parameters) override;
+	s32 RunRange(const u8* src, u8* dst, int count) override;
 	bool EnvironmentIsSupported() override;
 private:
 	u32 m_src_ofs = 0;
 	u32 m_dst_ofs = 0;
 	Gen::FixupBranch m_skip_vertex;
+
+	// The AVX2 loop converts two vertices per iteration. It replays the attribute reads
+	// recorded while generating the single vertex loop, so it only supports formats
+	// where every attribute is at a fixed offset inside the vertex.
+	struct PairedAttribute
+	{
+		bool is_color;
+		Gen::OpArg data;
+		u32 dst_ofs;
+		int format;
+		int count_in;
+		int count_out;
+		bool dequantize;
+		Gen::X64Reg scaling_register;
+	};
+	bool m_use_avx2 = false;
+	u32 m_posmtx_ofs = 0;
+	std::vector<PairedAttribute> m_paired_attributes;
+
 	Gen::OpArg GetVertexAddr(int array, u64 attribute);
 	int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, Gen::X64Reg scaling_register);
 	void ReadColor(Gen::OpArg data, u64 attribute, int format);
+	bool CanUseAVX2() const;
+	void LoadScaleFactor(Gen::X64Reg reg, const void* scale);
+	void ConvertVertexPair(const PairedAttribute& attribute, Gen::X64Reg result);
+	void StoreVertexPair(const PairedAttribute& attribute, Gen::X64Reg result, int vertex);
+	void ReadColorPair(const PairedAttribute& attribute, int vertex);
+	void GeneratePairLoop(const u8* single_loop, const u8* done);
 	void GenerateVertexLoader();
 };
@@ -162,6 +162,7 @@ void VideoConfig::Load(const std::string& ini_file)
 
 	settings->Get("EnableValidationLayer", &bEnableValidationLayer, false);
 	settings->Get("BackendMultithreading", &bBackendMultithreading, true);
+	settings->Get("ParallelVertexLoading", &bParallelVertexLoading, true);
 	settings->Get("CommandBufferExecuteInterval", &iCommandBufferExecuteInterval, 100);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
@@ -313,6 +314,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "DisableFog", bDisableFog);
 	CHECK_SETTING("Video_Settings", "EnableOpenCL", bEnableOpenCL);
 	CHECK_SETTING("Video_Settings", "BackendMultithreading", bBackendMultithreading);
+	CHECK_SETTING("Video_Settings", "ParallelVertexLoading", bParallelVertexLoading);
 	CHECK_SETTING("Video_Settings", "CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
 
 	// These are not overrides, they are per-game stereoscopy parameters, hence no warning
@@ -515,6 +517,7 @@ void VideoConfig::Save(const std::string& ini_file)
 
 	settings->Set("EnableValidationLayer", bEnableValidationLayer);
 	settings->Set("BackendMultithreading", bBackendMultithreading);
+	settings->Set("ParallelVertexLoading", bParallelVertexLoading);
 	settings->Set("CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
@@ -231,6 +231,9 @@ struct VideoConfig final
 	// Multithreaded submission, currently only supported with Vulkan.
 	bool bBackendMultithreading;
 
+	// Split large draw batches across worker threads for vertex loading and index generation.
+	bool bParallelVertexLoading;
+
 	// Early command buffer execution interval in number of draws.
 	// Currently only supported with Vulkan.
 	int iCommandBufferExecuteInterval;
@@ -0,0 +1,131 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "AudioCommon/Mixer.h"
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+
+class MixerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    SConfig::GetInstance().iTimingVariance = 8;
+    SConfig::GetInstance().m_EmulationSpeed = 1.0f;
+  }
+
+  void TearDown() override { SConfig::Shutdown(); }
+
+  // Stereo frames as the DSP sends them, big endian.
+  static std::vector<s16> MakeFrames(u32 count, s16 left, s16 right)
+  {
+    std::vector<s16> frames;
+    for (u32 i = 0; i < count; ++i)
+    {
+      frames.push_back(Common::swap16(left));
+      frames.push_back(Common::swap16(right));
+    }
+    return frames;
+  }
+
+  CMixer m_mixer{48000};
+};
+
+// Whatever the interpolation, a constant input has to come out as the same constant
+// (scaled by the 255/256 default volume), in the right channel order.
+TEST_F(MixerTest, DMAConstantSignal)
+{
+  std::vector<s16> frames = MakeFrames(1024, 0x2000, -0x4000);
+  m_mixer.PushSamples(frames.data(), 1024);
+
+  std::vector<float> output(2 * 480);
+  ASSERT_EQ(480u, m_mixer.Mix(output.data(), 480));
+  for (u32 i = 0; i < 480; ++i)
+  {
+    EXPECT_NEAR(-0.5f * 255 / 256, output[i * 2], 1e-6f) << i;
+    EXPECT_NEAR(0.25f * 255 / 256, output[i * 2 + 1], 1e-6f) << i;
+  }
+}
+
+TEST_F(MixerTest, WiimoteConstantSignal)
+{
+  // The Wiimote speaker is mono and little endian.
+  std::vector<s16> samples(300, 0x1000);
+  m_mixer.PushWiimoteSpeakerSamples(samples.data(), 300, 3000);
+
+  std::vector<float> output(2 * 480);
+  m_mixer.Mix(output.data(), 480);
+  for (u32 i = 0; i < 2 * 480; ++i)
+    EXPECT_NEAR(0.125f * 255 / 256, output[i], 1e-6f) << i;
+}
+
+TEST_F(MixerTest, ClampsToS16)
+{
+  // Both FIFOs at full scale add up to twice the range.
+  std::vector<s16> frames = MakeFrames(1024, 0x7fff, -0x8000);
+  m_mixer.PushSamples(frames.data(), 1024);
+  m_mixer.SetStreamingVolume(255, 255);
+  m_mixer.PushStreamingSamples(frames.data(), 1024);
+
+  std::vector<s16> output(2 * 480);
+  m_mixer.Mix(output.data(), 480);
+  for (u32 i = 0; i < 480; ++i)
+  {
+    EXPECT_EQ(-32768, output[i * 2]) << i;
+    EXPECT_EQ(32767, output[i * 2 + 1]) << i;
+  }
+}
+
+// Mixing one frame per call only ever runs the scalar interpolation and clamping code, while
+// a whole block runs through the SIMD code, which has to give exactly the same result.
+TEST_F(MixerTest, SIMDMatchesScalar)
+{
+  // A low watermark far above the FIFO fill levels keeps the rate correction at its limit,
+  // so both mixers step through the input at the same ratio however they are called.
+  SConfig::GetInstance().iTimingVariance = 1000;
+
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> sample(-0x8000, 0x7fff);
+  std::uniform_int_distribution<u32> volume(0, 255);
+  std::vector<s16> dma(2 * 1000), streaming(2 * 1000), wiimote(300);
+  for (s16& s : dma)
+    s = Common::swap16(static_cast<s16>(sample(rng)));
+  for (s16& s : streaming)
+    s = Common::swap16(static_cast<s16>(sample(rng)));
+  for (s16& s : wiimote)
+    s = Common::swap16(static_cast<s16>(sample(rng)));
+  const u32 volumes[4] = {volume(rng), volume(rng), volume(rng), volume(rng)};
+
+  auto fill = [&](CMixer& mixer) {
+    mixer.PushSamples(dma.data(), 1000);
+    mixer.SetStreamingVolume(volumes[0], volumes[1]);
+    mixer.PushStreamingSamples(streaming.data(), 1000);
+    mixer.SetWiimoteSpeakerVolume(volumes[2], volumes[3]);
+    mixer.PushWiimoteSpeakerSamples(wiimote.data(), 300, 3000);
+  };
+
+  CMixer batched{48000}, scalar{48000};
+  fill(batched);
+  fill(scalar);
+  std::vector<float> batched_float(2 * 240), scalar_float(2 * 240);
+  batched.Mix(batched_float.data(), 240);
+  for (u32 i = 0; i < 240; ++i)
+    scalar.Mix(&scalar_float[i * 2], 1);
+  for (u32 i = 0; i < 2 * 240; ++i)
+    EXPECT_EQ(scalar_float[i], batched_float[i]) << i;
+
+  std::vector<s16> batched_s16(2 * 240), scalar_s16(2 * 240);
+  batched.Mix(batched_s16.data(), 240);
+  for (u32 i = 0; i < 240; ++i)
+    scalar.Mix(&scalar_s16[i * 2], 1);
+  for (u32 i = 0; i < 2 * 240; ++i)
+    EXPECT_EQ(scalar_s16[i], batched_s16[i]) << i;
+}
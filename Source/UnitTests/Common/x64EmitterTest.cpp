@@ -1018,6 +1018,54 @@ AVX_RRM_TEST(VPANDN, "dqword")
 AVX_RRM_TEST(VPOR, "dqword")
 AVX_RRM_TEST(VPXOR, "dqword")
 
+TEST_F(x64EmitterTest, VEX_128_MOVs)
+{
+  for (const auto& r : xmmnames)
+  {
+    emitter->VMOVD_xmm(r.reg, MatR(R12));
+    emitter->VMOVQ_xmm(r.reg, MatR(R12));
+    emitter->VMOVDQU(r.reg, MatR(R12));
+    emitter->VMOVSS(MatR(R12), r.reg);
+    emitter->VMOVLPS(MatR(R12), r.reg);
+    emitter->VMOVUPS(MatR(R12), r.reg);
+    ExpectDisassembly("vmovd " + r.name + ", dword ptr ds:[r12] "
+                      "vmovq " + r.name + ", qword ptr ds:[r12] "
+                      "vmovdqu " + r.name + ", dqword ptr ds:[r12] "
+                      "vmovss dword ptr ds:[r12], " + r.name + " "
+                      "vmovlps qword ptr ds:[r12], " + r.name + " "
+                      "vmovups dqword ptr ds:[r12], " + r.name);
+  }
+}
+
+TEST_F(x64EmitterTest, VZEROUPPER)
+{
+  emitter->VZEROUPPER();
+  ExpectDisassembly("vzeroupper");
+}
+
+TEST_F(x64EmitterTest, AVX2_256)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VBROADCASTSS(r.reg, MatR(R12));
+    emitter->VPBROADCASTD(r.reg, MatR(R12));
+    emitter->VPBROADCASTQ(r.reg, MatR(R12));
+    emitter->VCVTDQ2PS(r.reg, R(YMM1));
+    emitter->VMULPS(r.reg, YMM1, R(YMM2));
+    emitter->VPSHUFB(r.reg, YMM1, MatR(R12));
+    emitter->VPSRAD(r.reg, YMM1, 16);
+    emitter->VPBLENDD(r.reg, YMM1, R(YMM2), 0xF0);
+    ExpectDisassembly("vbroadcastss " + r.name + ", dword ptr ds:[r12] "
+                      "vpbroadcastd " + r.name + ", dword ptr ds:[r12] "
+                      "vpbroadcastq " + r.name + ", qword ptr ds:[r12] "
+                      "vcvtdq2ps " + r.name + ", ymm1 "
+                      "vmulps " + r.name + ", ymm1, ymm2 "
+                      "vpshufb " + r.name + ", ymm1, qqword ptr ds:[r12] "
+                      "vpsrad " + r.name + ", ymm1, 0x10 "
+                      "vpblendd " + r.name + ", ymm1, ymm2, 0xf0");
+  }
+}
+
 #define FMA3_TEST(Name, P, packed)                                                                 \
   AVX_RRM_TEST(Name##132##P##S, packed ? "dqword" : "dword")                                       \
   AVX_RRM_TEST(Name##213##P##S, packed ? "dqword" : "dword")                                       \
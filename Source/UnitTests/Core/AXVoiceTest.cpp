@@ -0,0 +1,235 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/DSPHLE/UCodes/AX.h"
+#include "Core/HW/DSPHLE/UCodes/AXCapture.h"
+#include "Core/HW/DSPHLE/UCodes/AXStructs.h"
+
+// AXBuffers order on GC: left, right, surround, then AUXA and AUXB.
+static const u32 GC_BUFFER_COUNT = 9;
+// On Wii, AUXC follows, then the main and AUX buffers of the four Wiimotes.
+static const u32 WII_MAIN_BUFFER_COUNT = 12;
+static const u32 WII_BUFFER_COUNT = 20;
+
+class ScopeInit final
+{
+public:
+  ScopeInit() { SConfig::Init(); }
+  ~ScopeInit() { SConfig::Shutdown(); }
+};
+
+// A GC voice playing <count> 16-bit PCM samples from ARAM address 0, without
+// resampling and at unity volume, mixed to the left channel only.
+static AXCapture::VoiceFrame MakePCMVoice(const std::vector<s16>& samples)
+{
+  AXPB pb;
+  memset(&pb, 0, sizeof(pb));
+  pb.running = 1;
+  pb.src_type = SRCTYPE_NEAREST;
+  pb.audio_addr.sample_format = 0x0A;
+  pb.audio_addr.end_addr_lo = 0x1000;
+  pb.vol_env.cur_volume = 0x8000;
+  pb.mixer.left = 0x8000;
+
+  AXCapture::VoiceFrame frame;
+  frame.sample_count = static_cast<u16>(samples.size());
+  frame.mixer_control = MIX_L;
+  frame.pb_in.assign(reinterpret_cast<u8*>(&pb), reinterpret_cast<u8*>(&pb) + sizeof(pb));
+  for (s16 sample : samples)
+  {
+    frame.aram.push_back(static_cast<u8>(static_cast<u16>(sample) >> 8));
+    frame.aram.push_back(static_cast<u8>(sample));
+  }
+  frame.buffer_sizes.assign(GC_BUFFER_COUNT, static_cast<u32>(samples.size()));
+  frame.mix.resize(GC_BUFFER_COUNT * samples.size());
+  return frame;
+}
+
+TEST(AXVoice, PCMVoiceAtUnityVolume)
+{
+  ScopeInit guard;
+
+  std::vector<s16> samples;
+  for (int i = 0; i < 32; ++i)
+    samples.push_back(static_cast<s16>(i * 1000 - 16000));
+  samples[5] = -32768;  // Volume scaling clamps to -32767.
+
+  AXCapture::VoiceFrame frame = MakePCMVoice(samples);
+  AXCapture::VoiceFrame result;
+  ASSERT_TRUE(AXCapture::ReplayFrame(frame, &result));
+
+  // Every byte of the input and nothing more.
+  EXPECT_EQ(frame.aram, result.aram);
+
+  for (u32 i = 0; i < 32; ++i)
+    EXPECT_EQ(i == 5 ? -32767 : samples[i], result.mix[i]);
+  for (u32 i = 32; i < result.mix.size(); ++i)
+    EXPECT_EQ(0, result.mix[i]);
+
+  AXPB pb;
+  memcpy(&pb, result.pb_out.data(), sizeof(pb));
+  EXPECT_EQ(32, pb.audio_addr.cur_addr_lo);
+  EXPECT_EQ(1, pb.running);
+}
+
+TEST(AXVoice, ReplayIsDeterministic)
+{
+  ScopeInit guard;
+
+  std::vector<s16> samples;
+  for (int i = 0; i < 32; ++i)
+    samples.push_back(static_cast<s16>((i * 7919) & 0xFFFF));
+  AXCapture::VoiceFrame frame = MakePCMVoice(samples);
+
+  // Use the first replay as the golden output for the second one.
+  AXCapture::VoiceFrame golden, result;
+  ASSERT_TRUE(AXCapture::ReplayFrame(frame, &golden));
+  frame.pb_out = golden.pb_out;
+  frame.mix = golden.mix;
+  ASSERT_TRUE(AXCapture::ReplayFrame(frame, &result));
+  EXPECT_TRUE(AXCapture::FramesMatch(frame, result));
+
+  // A capture missing ARAM bytes must not match.
+  frame.aram.pop_back();
+  ASSERT_TRUE(AXCapture::ReplayFrame(frame, &result));
+  EXPECT_FALSE(AXCapture::FramesMatch(frame, result));
+}
+
+TEST(AXVoice, CaptureRoundTrip)
+{
+  ScopeInit guard;
+
+  const std::string dir = File::CreateTempDir();
+  const std::string path = dir + "/voices.axcap";
+
+  AXPB pb;
+  memset(&pb, 0, sizeof(pb));
+  pb.running = 1;
+  int mixed[GC_BUFFER_COUNT][32] = {};
+  int* buffers[GC_BUFFER_COUNT];
+  u32 sizes[GC_BUFFER_COUNT];
+  for (u32 i = 0; i < GC_BUFFER_COUNT; ++i)
+  {
+    buffers[i] = mixed[i];
+    sizes[i] = 32;
+  }
+  mixed[1][3] = 100;  // Already mixed by a previous voice.
+
+  {
+    AXCapture::Recorder recorder(path);
+    ASSERT_TRUE(recorder.IsOpen());
+    recorder.BeginVoice(false, &pb, sizeof(pb), buffers, sizes, GC_BUFFER_COUNT, 32, MIX_R);
+    mixed[1][3] += 42;
+    pb.running = 0;
+    recorder.EndVoice(&pb);
+  }
+
+  std::vector<AXCapture::VoiceFrame> frames;
+  ASSERT_TRUE(AXCapture::LoadCapture(path, &frames));
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_FALSE(frames[0].wii);
+  EXPECT_EQ(32, frames[0].sample_count);
+  EXPECT_EQ(static_cast<u32>(MIX_R), frames[0].mixer_control);
+  EXPECT_EQ(sizeof(pb), frames[0].pb_in.size());
+  EXPECT_EQ(1, reinterpret_cast<const AXPB*>(frames[0].pb_in.data())->running);
+  EXPECT_EQ(0, reinterpret_cast<const AXPB*>(frames[0].pb_out.data())->running);
+  EXPECT_EQ(42, frames[0].mix[32 + 3]);
+
+  File::DeleteDirRecursively(dir);
+}
+
+// The Wiimote buffers hold fewer samples than the others, and are captured with their own size.
+TEST(AXVoice, CaptureWiimoteBuffers)
+{
+  ScopeInit guard;
+
+  const std::string dir = File::CreateTempDir();
+  const std::string path = dir + "/voices.axcap";
+
+  AXPBWii pb;
+  memset(&pb, 0, sizeof(pb));
+  pb.running = 1;
+  std::vector<std::vector<int>> mixed;
+  std::vector<int*> buffers;
+  std::vector<u32> sizes;
+  for (u32 i = 0; i < WII_BUFFER_COUNT; ++i)
+  {
+    sizes.push_back(i < WII_MAIN_BUFFER_COUNT ? 96 : 18);
+    mixed.emplace_back(sizes.back());
+    buffers.push_back(mixed.back().data());
+  }
+
+  {
+    AXCapture::Recorder recorder(path);
+    ASSERT_TRUE(recorder.IsOpen());
+    recorder.BeginVoice(true, &pb, sizeof(pb), buffers.data(), sizes.data(), WII_BUFFER_COUNT, 96,
+                        0);
+    mixed[WII_BUFFER_COUNT - 1][17] += 7;
+    recorder.EndVoice(&pb);
+  }
+
+  std::vector<AXCapture::VoiceFrame> frames;
+  ASSERT_TRUE(AXCapture::LoadCapture(path, &frames));
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_EQ(sizes, frames[0].buffer_sizes);
+  ASSERT_EQ(WII_MAIN_BUFFER_COUNT * 96 + (WII_BUFFER_COUNT - WII_MAIN_BUFFER_COUNT) * 18,
+            frames[0].mix.size());
+  EXPECT_EQ(7, frames[0].mix.back());
+
+  // Replaying gives the Wiimote buffers the same sizes.
+  AXCapture::VoiceFrame result;
+  ASSERT_TRUE(AXCapture::ReplayFrame(frames[0], &result));
+  EXPECT_EQ(frames[0].mix.size(), result.mix.size());
+
+  File::DeleteDirRecursively(dir);
+}
+
+// Replays every capture in $AX_CAPTURE_DIR (recorded with the DSP capture log
+// enabled) against its own output and reports the voice throughput.
+TEST(AXVoice, ReplayCaptures)
+{
+  const char* capture_dir = getenv("AX_CAPTURE_DIR");
+  if (!capture_dir)
+  {
+    printf("AX_CAPTURE_DIR not set, no captures to replay\n");
+    return;
+  }
+
+  ScopeInit guard;
+
+  for (const std::string& path : DoFileSearch({".axcap"}, {capture_dir}))
+  {
+    std::vector<AXCapture::VoiceFrame> frames;
+    ASSERT_TRUE(AXCapture::LoadCapture(path, &frames)) << path;
+
+    size_t mismatches = 0;
+    AXCapture::VoiceFrame result;
+    auto start = std::chrono::steady_clock::now();
+    for (const AXCapture::VoiceFrame& frame : frames)
+    {
+      ASSERT_TRUE(AXCapture::ReplayFrame(frame, &result)) << path;
+      if (!AXCapture::FramesMatch(frame, result))
+        ++mismatches;
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(0u, mismatches) << path;
+    printf("%s: %zu voice frames, %.0f voices/s\n", path.c_str(), frames.size(),
+           seconds > 0 ? frames.size() / seconds : 0.0);
+  }
+}
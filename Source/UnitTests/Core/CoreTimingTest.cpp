@@ -4,9 +4,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <vector>
 
+#include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -318,3 +323,124 @@ TEST(CoreTiming, Overclocking)
   SConfig::GetInstance().m_OCFactor = 1.0;
   AdvanceAndCheck(4, MAX_SLICE_LENGTH);
 }
+
+namespace ManyEventsTest
+{
+struct Record
+{
+  s64 time;
+  u64 id;
+};
+static std::vector<Record> s_records;
+
+static void RecordCallback(u64 userdata, s64 lateness)
+{
+  s_records.push_back({static_cast<s64>(CoreTiming::GetTicks()) - lateness, userdata});
+}
+}
+
+// Mixes events close by, far beyond the scheduler's wheel and in the past, and checks that
+// they run exactly in (time, scheduling order).
+TEST(CoreTiming, ManyEvents)
+{
+  using namespace ManyEventsTest;
+
+  ScopeInit guard;
+
+  std::array<CoreTiming::EventType*, 8> types;
+  for (size_t i = 0; i < types.size(); ++i)
+    types[i] = CoreTiming::RegisterEvent(StringFromFormat("callback%zu", i), RecordCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  std::vector<Record> expected;
+  u32 seed = 12345;
+  for (u64 id = 0; id < 4000; ++id)
+  {
+    seed = seed * 1103515245 + 12345;
+    s64 delay = seed >> 8;
+    if (id % 5 == 0)
+      delay %= 4000;
+    else if (id % 7 == 0)
+      delay = -static_cast<s64>(delay % 100);
+
+    CoreTiming::ScheduleEvent(delay, types[id % types.size()], id);
+    if (id % types.size() != 3)
+      expected.push_back({delay, id});
+  }
+  CoreTiming::RemoveEvent(types[3]);
+
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const Record& a, const Record& b) { return a.time < b.time; });
+
+  s_records.clear();
+  for (int i = 0; i < 100000 && s_records.size() < expected.size(); ++i)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+
+  ASSERT_EQ(expected.size(), s_records.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    EXPECT_EQ(expected[i].id, s_records[i].id) << i;
+    EXPECT_EQ(expected[i].time, s_records[i].time) << i;
+  }
+}
+
+namespace ThroughputTest
+{
+// Roughly the periods of audio DMA, DSP, SI polling, VI lines, VI fields and a slow timer.
+static constexpr std::array<s64, 6> PERIODS{{1800, 5000, 16000, 15000, 8100000, 40500000}};
+static std::array<CoreTiming::EventType*, PERIODS.size() * 40> s_types;
+static u64 s_events_run = 0;
+
+static void PeriodicCallback(u64 userdata, s64 lateness)
+{
+  ++s_events_run;
+  CoreTiming::ScheduleEvent(PERIODS[userdata % PERIODS.size()] - lateness, s_types[userdata],
+                            userdata);
+}
+
+static double Run(size_t type_count)
+{
+  ScopeInit guard;
+
+  for (size_t i = 0; i < type_count; ++i)
+    s_types[i] = CoreTiming::RegisterEvent(StringFromFormat("periodic%zu", i), PeriodicCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  for (size_t i = 0; i < type_count; ++i)
+    CoreTiming::ScheduleEvent(PERIODS[i % PERIODS.size()] + static_cast<s64>(i), s_types[i], i);
+
+  static constexpr u64 EVENTS = 2000000;
+  s_events_run = 0;
+  const auto start = std::chrono::steady_clock::now();
+  while (s_events_run < EVENTS)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return s_events_run / elapsed.count();
+}
+}
+
+// Not correctness tests: they measure how many events per second the scheduler runs with the
+// usual handful of devices, and with many more.
+TEST(CoreTiming, EventThroughput)
+{
+  const double events_per_second = ThroughputTest::Run(ThroughputTest::PERIODS.size());
+  RecordProperty("EventsPerSecond", static_cast<int>(events_per_second));
+  std::printf("CoreTiming: %.0f events per second\n", events_per_second);
+}
+
+TEST(CoreTiming, ManyEventThroughput)
+{
+  const double events_per_second = ThroughputTest::Run(ThroughputTest::s_types.size());
+  RecordProperty("EventsPerSecond", static_cast<int>(events_per_second));
+  std::printf("CoreTiming: %.0f events per second\n", events_per_second);
+}
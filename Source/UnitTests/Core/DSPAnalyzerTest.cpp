@@ -0,0 +1,97 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <initializer_list>
+
+// DSPTables.h pulls in the x64Emitter, whose TEST method conflicts with the gtest
+// macro. Only TEST_F is used in this file.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPTables.h"
+
+class DSPAnalyzerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    InitInstructionTable();
+    // Fill everything with HALT.
+    m_iram.fill(0x0021);
+    m_irom.fill(0x0021);
+    g_dsp.iram = m_iram.data();
+    g_dsp.irom = m_irom.data();
+  }
+
+  void TearDown() override
+  {
+    g_dsp.iram = nullptr;
+    g_dsp.irom = nullptr;
+  }
+
+  void Write(u16 addr, std::initializer_list<u16> code)
+  {
+    std::copy(code.begin(), code.end(), m_iram.begin() + addr);
+  }
+
+  bool IsIdleSkip(u16 addr) const
+  {
+    return (DSPAnalyzer::GetCodeFlags(addr) & DSPAnalyzer::CODE_IDLE_SKIP) != 0;
+  }
+
+private:
+  std::array<u16, DSP_IRAM_SIZE> m_iram;
+  std::array<u16, DSP_IROM_SIZE> m_irom;
+};
+
+TEST_F(DSPAnalyzerTest, KnownSignature)
+{
+  Write(0x10, {
+                  0x26fc,          // LRS   $AC0.M, @DMBH
+                  0x02c0, 0x8000,  // ANDCF $AC0.M, #0x8000
+                  0x029d, 0x0010,  // JLZ   0x0010
+                  0x02df,          // RET
+              });
+  DSPAnalyzer::Analyze();
+  EXPECT_TRUE(IsIdleSkip(0x10));
+}
+
+TEST_F(DSPAnalyzerTest, MailWaitLoop)
+{
+  Write(0x20, {
+                  0x00df, 0xfffc,  // LR   $AC1.M, @DMBH
+                  0x03a0, 0x8000,  // ANDF $AC1.M, #0x8000
+                  0x029c, 0x0020,  // JLNZ 0x0020
+              });
+  DSPAnalyzer::Analyze();
+  EXPECT_TRUE(IsIdleSkip(0x20));
+  EXPECT_FALSE(IsIdleSkip(0x22));
+}
+
+TEST_F(DSPAnalyzerTest, LoopsWithSideEffects)
+{
+  Write(0x20, {
+                  0x00cc, 0xfffc,  // LR   $ST0, @DMBH (pushes the call stack)
+                  0x029c, 0x0020,  // JLNZ 0x0020
+              });
+  Write(0x30, {
+                  0x00de, 0x0352,  // LR   $AC0.M, @0x0352 (DRAM, written by DMA)
+                  0x02a0, 0x8000,  // ANDF $AC0.M, #0x8000
+                  0x029c, 0x0030,  // JLNZ 0x0030
+              });
+  Write(0x40, {
+                  0x00de, 0xfffe,  // LR   $AC0.M, @CMBH
+                  0x0400,          // ADDIS $AC0.M, #0x00
+                  0x029c, 0x0040,  // JLNZ 0x0040
+              });
+  DSPAnalyzer::Analyze();
+  EXPECT_FALSE(IsIdleSkip(0x20));
+  EXPECT_FALSE(IsIdleSkip(0x30));
+  EXPECT_FALSE(IsIdleSkip(0x40));
+}
@@ -0,0 +1,78 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/Rewind.h"
+
+static std::vector<u8> MakeState(size_t size, u32 seed)
+{
+  std::vector<u8> state(size);
+  for (size_t i = 0; i < size; ++i)
+    state[i] = static_cast<u8>((i * 7 + i / 97) ^ seed);
+  return state;
+}
+
+TEST(Rewind, DeltaRoundTrip)
+{
+  // Odd size, so the tail after the last whole word is covered too.
+  const std::vector<u8> base = MakeState(10007, 0);
+  std::vector<u8> state = base;
+  state[0] ^= 1;
+  state[100] ^= 0xFF;
+  for (size_t i = 5000; i < 5100; ++i)
+    state[i] = 0;
+  state[state.size() - 1] ^= 0x80;
+
+  std::vector<u8> delta;
+  Rewind::EncodeDelta(base.data(), state.data(), state.size(), &delta);
+  EXPECT_LT(delta.size(), state.size() / 10);
+
+  // Forwards, then backwards.
+  std::vector<u8> result = base;
+  ASSERT_TRUE(Rewind::ApplyDelta(delta.data(), delta.size(), result.data(), result.size()));
+  EXPECT_EQ(state, result);
+  ASSERT_TRUE(Rewind::ApplyDelta(delta.data(), delta.size(), result.data(), result.size()));
+  EXPECT_EQ(base, result);
+}
+
+TEST(Rewind, IdenticalStates)
+{
+  const std::vector<u8> state = MakeState(4096, 3);
+
+  std::vector<u8> delta(1);
+  Rewind::EncodeDelta(state.data(), state.data(), state.size(), &delta);
+  EXPECT_TRUE(delta.empty());
+}
+
+TEST(Rewind, Keyframe)
+{
+  std::vector<u8> state(20000);
+  for (size_t i = 8000; i < 8013; ++i)
+    state[i] = static_cast<u8>(i);
+
+  std::vector<u8> delta;
+  Rewind::EncodeDelta(nullptr, state.data(), state.size(), &delta);
+  EXPECT_LT(delta.size(), 64u);
+
+  std::vector<u8> result(state.size());
+  ASSERT_TRUE(Rewind::ApplyDelta(delta.data(), delta.size(), result.data(), result.size()));
+  EXPECT_EQ(state, result);
+}
+
+TEST(Rewind, RejectsOversizedDelta)
+{
+  const std::vector<u8> base(64);
+  const std::vector<u8> state = MakeState(64, 1);
+
+  std::vector<u8> delta;
+  Rewind::EncodeDelta(base.data(), state.data(), state.size(), &delta);
+
+  std::vector<u8> result(64);
+  EXPECT_FALSE(Rewind::ApplyDelta(delta.data(), delta.size(), result.data(), 32));
+  EXPECT_FALSE(Rewind::ApplyDelta(delta.data(), delta.size() - 1, result.data(), result.size()));
+}
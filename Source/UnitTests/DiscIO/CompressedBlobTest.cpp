@@ -0,0 +1,159 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CompressedBlob.h"
+
+static const u32 BLOCK_SIZE = 16384;
+static const u32 NUM_BLOCKS = 300;
+
+static bool IgnoreProgress(const std::string&, float, void*)
+{
+  return true;
+}
+
+class CompressedBlobTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    // 64 blocks, so reading the whole image goes through plenty of evictions.
+    SConfig::GetInstance().iGCZCacheSize = 1;
+
+    // Alternate compressible and random blocks, so both ways of storing them are covered.
+    m_data.resize(BLOCK_SIZE * NUM_BLOCKS);
+    u32 seed = 12345;
+    for (u32 i = 0; i < m_data.size(); ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      m_data[i] = (i / BLOCK_SIZE) % 3 == 0 ? static_cast<u8>(seed >> 16) : static_cast<u8>(i / 7);
+    }
+
+    m_dir = File::CreateTempDir();
+    m_iso_path = m_dir + "/test.iso";
+    m_gcz_path = m_dir + "/test.gcz";
+    File::IOFile iso(m_iso_path, "wb");
+    ASSERT_TRUE(iso.WriteBytes(m_data.data(), m_data.size()));
+    iso.Close();
+    ASSERT_TRUE(DiscIO::CompressFileToBlob(m_iso_path, m_gcz_path, 0, BLOCK_SIZE, IgnoreProgress,
+                                           nullptr));
+  }
+
+  void TearDown() override
+  {
+    File::DeleteDirRecursively(m_dir);
+    SConfig::Shutdown();
+  }
+
+  void ExpectSequentialReads(DiscIO::IBlobReader* reader)
+  {
+    // Like the DVD thread streaming a file: unaligned, and ahead of the read-ahead.
+    std::vector<u8> buffer(0x8000);
+    for (u64 offset = 0x123; offset < m_data.size(); offset += buffer.size())
+    {
+      const u64 size = std::min<u64>(buffer.size(), m_data.size() - offset);
+      ASSERT_TRUE(reader->Read(offset, size, buffer.data())) << offset;
+      ASSERT_TRUE(std::equal(buffer.begin(), buffer.begin() + size, m_data.begin() + offset))
+          << offset;
+    }
+  }
+
+  std::vector<u8> m_data;
+  std::string m_dir;
+  std::string m_iso_path;
+  std::string m_gcz_path;
+};
+
+TEST_F(CompressedBlobTest, SequentialReads)
+{
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+  EXPECT_EQ(m_data.size(), reader->GetDataSize());
+  ExpectSequentialReads(reader.get());
+}
+
+TEST_F(CompressedBlobTest, RandomReads)
+{
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_TRUE(reader);
+
+  // Up to 40 blocks at once, which is more than a single request of a 64 block cache.
+  std::vector<u8> buffer(40 * BLOCK_SIZE);
+  u32 seed = 42;
+  for (int i = 0; i < 500; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    const u64 offset = seed % m_data.size();
+    seed = seed * 1103515245 + 12345;
+    const u64 size = std::min<u64>(seed % buffer.size() + 1, m_data.size() - offset);
+    ASSERT_TRUE(reader->Read(offset, size, buffer.data())) << offset;
+    ASSERT_TRUE(std::equal(buffer.begin(), buffer.begin() + size, m_data.begin() + offset))
+        << offset << " " << size;
+  }
+}
+
+// Scanning the game list only reads the first block, which must not start any threads.
+TEST_F(CompressedBlobTest, HeaderReadsStartNoWorkers)
+{
+  std::unique_ptr<DiscIO::CompressedBlobReader> reader =
+      DiscIO::CompressedBlobReader::Create(File::IOFile(m_gcz_path, "rb"), m_gcz_path);
+  ASSERT_TRUE(reader);
+
+  std::vector<u8> buffer(0x440);
+  ASSERT_TRUE(reader->Read(0, buffer.size(), buffer.data()));
+  ASSERT_TRUE(reader->Read(0x18, 4, buffer.data()));
+  ASSERT_TRUE(reader->Read(0x1C, 4, buffer.data()));
+  EXPECT_EQ(0u, reader->GetWorkerCount());
+
+  // Moving on to the next block is sequential, and reads ahead.
+  ASSERT_TRUE(reader->Read(BLOCK_SIZE, 0x100, buffer.data()));
+  EXPECT_LT(0u, reader->GetWorkerCount());
+}
+
+TEST_F(CompressedBlobTest, ReadPastEnd)
+{
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_TRUE(reader);
+
+  std::vector<u8> buffer(BLOCK_SIZE);
+  EXPECT_FALSE(reader->Read(m_data.size() - 16, 32, buffer.data()));
+  EXPECT_FALSE(reader->Read(m_data.size(), 1, buffer.data()));
+  EXPECT_TRUE(reader->Read(m_data.size() - 16, 16, buffer.data()));
+}
+
+TEST_F(CompressedBlobTest, LZOCodec)
+{
+  const std::string lzo_path = m_dir + "/test_lzo.gcz";
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_iso_path, lzo_path, 0, BLOCK_SIZE, IgnoreProgress,
+                                         nullptr, DiscIO::GCZCodec::LZO));
+
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(lzo_path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+  // The compressible blocks really are compressed.
+  EXPECT_LT(reader->GetRawSize(), m_data.size());
+  ExpectSequentialReads(reader.get());
+
+  // Converting back gives the original image.
+  const std::string iso_path = m_dir + "/test_lzo.iso";
+  reader.reset();
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(lzo_path, iso_path, IgnoreProgress, nullptr));
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(iso_path, contents));
+  EXPECT_TRUE(contents.size() == m_data.size() &&
+              std::equal(m_data.begin(), m_data.end(), contents.begin(),
+                         [](u8 a, char b) { return a == static_cast<u8>(b); }));
+}
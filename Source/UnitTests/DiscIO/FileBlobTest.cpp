@@ -0,0 +1,100 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CISOBlob.h"
+
+static const u32 CISO_BLOCK_SIZE = 0x8000;
+static const u32 CISO_BLOCKS = 8;
+
+class FileBlobTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_data.resize(CISO_BLOCK_SIZE * CISO_BLOCKS);
+    for (u32 i = 0; i < m_data.size(); ++i)
+      m_data[i] = static_cast<u8>(i * 31 + i / 251);
+
+    m_dir = File::CreateTempDir();
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_dir); }
+
+  // Reads the whole image at odd offsets and sizes, so reads straddle CISO blocks.
+  void ExpectData(DiscIO::IBlobReader* reader, const std::vector<u8>& expected)
+  {
+    std::vector<u8> buffer(expected.size());
+    for (u64 offset = 0; offset < expected.size();)
+    {
+      const u64 size = std::min<u64>(12345, expected.size() - offset);
+      ASSERT_TRUE(reader->Read(offset, size, buffer.data() + offset)) << offset;
+      offset += size;
+    }
+    EXPECT_EQ(expected, buffer);
+  }
+
+  std::vector<u8> m_data;
+  std::string m_dir;
+};
+
+TEST_F(FileBlobTest, PlainFile)
+{
+  const std::string path = m_dir + "/test.iso";
+  File::IOFile iso(path, "wb");
+  ASSERT_TRUE(iso.WriteBytes(m_data.data(), m_data.size()));
+  iso.Close();
+
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(DiscIO::BlobType::PLAIN, reader->GetBlobType());
+  EXPECT_EQ(m_data.size(), reader->GetDataSize());
+  ExpectData(reader.get(), m_data);
+
+  u8 byte;
+  EXPECT_FALSE(reader->Read(m_data.size(), 1, &byte));
+  EXPECT_FALSE(reader->Read(m_data.size() - 1, 2, &byte));
+}
+
+TEST_F(FileBlobTest, CISO)
+{
+  // Every third block is left out of the image and has to read back as zeroes.
+  std::unique_ptr<DiscIO::CISOHeader> header(new DiscIO::CISOHeader);
+  memset(header.get(), 0, sizeof(DiscIO::CISOHeader));
+  header->magic = DiscIO::CISO_MAGIC;
+  header->block_size = CISO_BLOCK_SIZE;
+
+  const std::string path = m_dir + "/test.ciso";
+  File::IOFile ciso(path, "wb");
+  ASSERT_TRUE(ciso.WriteArray(header.get(), 1));
+  for (u32 i = 0; i < CISO_BLOCKS; ++i)
+  {
+    u8* block = &m_data[i * CISO_BLOCK_SIZE];
+    if (i % 3 == 1)
+    {
+      memset(block, 0, CISO_BLOCK_SIZE);
+      continue;
+    }
+    header->map[i] = 1;
+    ASSERT_TRUE(ciso.WriteBytes(block, CISO_BLOCK_SIZE));
+  }
+  ASSERT_TRUE(ciso.Seek(0, SEEK_SET));
+  ASSERT_TRUE(ciso.WriteArray(header.get(), 1));
+  ciso.Close();
+
+  std::unique_ptr<DiscIO::IBlobReader> reader = DiscIO::CreateBlobReader(path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(DiscIO::BlobType::CISO, reader->GetBlobType());
+  ExpectData(reader.get(), m_data);
+}